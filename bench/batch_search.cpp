@@ -0,0 +1,44 @@
+/**
+ * Batched lookups: searchBatch against a loop of search, on trees much
+ * larger than the last-level cache, for batches of 32 to 256 keys.
+ *   c++ -O2 -std=c++11 bench/batch_search.cpp -o batch_search
+ *   ./batch_search 10000000
+ */
+
+#include "bench.hpp"
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {10000000});
+    const size_t batches[] = {32, 64, 128, 256};
+
+    for (size_t n : sizes)
+    {
+        std::vector<long> keys = bench::randomKeys(n);
+        bench::tree_type tree;
+        for (long k : keys)
+            tree.RBTinsert(bench::pair_type(k, k));
+
+        size_t queries = std::min<size_t>(n, 2000000);
+        std::vector<long> probes = bench::randomKeys(n, 11);
+        probes.resize(queries);
+        std::vector<bench::tree_type::node_type*> out(queries);
+
+        bench::Timer t;
+        for (size_t i = 0; i < queries; ++i)
+            out[i] = tree.search(probes[i]);
+        bench::doNotOptimize(out[queries - 1]);
+        bench::report("search loop", n, queries, t.seconds());
+
+        for (size_t batch : batches)
+        {
+            std::string name = "searchBatch x" + std::to_string(batch);
+            bench::Timer b;
+            for (size_t i = 0; i < queries; i += batch)
+                tree.searchBatch(&probes[i], std::min(batch, queries - i), &out[i]);
+            bench::doNotOptimize(out[queries - 1]);
+            bench::report(name.c_str(), n, queries, b.seconds());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+#ifndef BENCH_HPP
+# define BENCH_HPP
+
+/**
+ * Small helpers shared by the benchmark programs in this directory.
+ * They are standalone C++11 programs that only use the public
+ * interface of red_black_tree.hpp, so the same source can be built
+ * against an older revision of the header to compare layouts.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../red_black_tree.hpp"
+
+namespace bench{
+
+    typedef std::pair<const long, long>                                 pair_type;
+    typedef ft::RBtree<pair_type, std::less<long>, std::allocator<pair_type> > tree_type;
+
+    /* Bytes currently allocated, and allocations made, through CountingAllocator. */
+    inline size_t& liveBytes()
+    {
+        static size_t bytes = 0;
+        return bytes;
+    }
+
+    inline size_t& allocationCount()
+    {
+        static size_t count = 0;
+        return count;
+    }
+
+    /* std::allocator that keeps liveBytes() and allocationCount() up to date; single-threaded. */
+    template<class T>
+    class CountingAllocator : public std::allocator<T>
+    {
+        public:
+            template<class U>
+            struct rebind { typedef CountingAllocator<U> other; };
+
+            CountingAllocator(){}
+            template<class U>
+            CountingAllocator(const CountingAllocator<U>&){}
+
+            T*  allocate(size_t n, const void* = 0)
+            {
+                liveBytes() += n * sizeof(T);
+                ++allocationCount();
+                return std::allocator<T>::allocate(n);
+            }
+
+            void    deallocate(T* p, size_t n)
+            {
+                liveBytes() -= n * sizeof(T);
+                std::allocator<T>::deallocate(p, n);
+            }
+    };
+
+    class Timer
+    {
+        public:
+            Timer():_start(std::chrono::steady_clock::now()){}
+
+            double  seconds() const
+            {
+                return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+            }
+
+        private:
+            std::chrono::steady_clock::time_point   _start;
+    };
+
+    /* Keeps the optimizer from discarding a computed value. */
+    template<class T>
+    inline void doNotOptimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    inline std::vector<long> randomKeys(size_t n, unsigned seed = 42)
+    {
+        std::vector<long> keys(n);
+        for (size_t i = 0; i < n; ++i)
+            keys[i] = static_cast<long>(i);
+        std::shuffle(keys.begin(), keys.end(), std::mt19937_64(seed));
+        return keys;
+    }
+
+    inline std::vector<long> sortedKeys(size_t n)
+    {
+        std::vector<long> keys(n);
+        for (size_t i = 0; i < n; ++i)
+            keys[i] = static_cast<long>(i);
+        return keys;
+    }
+
+    inline std::vector<long> reverseSortedKeys(size_t n)
+    {
+        std::vector<long> keys(n);
+        for (size_t i = 0; i < n; ++i)
+            keys[i] = static_cast<long>(n - 1 - i);
+        return keys;
+    }
+
+    /**
+     * count draws from [0, n) where the rank-i key comes up in proportion
+     * to 1 / (i + 1)^theta, with the ranks scattered over the key range.
+     * Uses the generator of Gray et al. ("Quickly generating billion-record
+     * synthetic databases"), which costs O(n) once to set up.
+     */
+    inline std::vector<long> zipfKeys(size_t n, size_t count, double theta = 0.99, unsigned seed = 7)
+    {
+        double zetaN = 0;
+        for (size_t i = 1; i <= n; ++i)
+            zetaN += 1.0 / std::pow(static_cast<double>(i), theta);
+        double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta);
+        double alpha = 1.0 / (1.0 - theta);
+        double eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetaN);
+
+        std::mt19937_64                         random(seed);
+        std::uniform_real_distribution<double>  uniform(0.0, 1.0);
+        std::vector<long>                       keys(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            double u = uniform(random);
+            double uz = u * zetaN;
+            size_t rank;
+            if (uz < 1.0)
+                rank = 0;
+            else if (uz < zeta2)
+                rank = 1;
+            else
+                rank = std::min(n - 1, static_cast<size_t>(n * std::pow(eta * u - eta + 1.0, alpha)));
+            keys[i] = static_cast<long>((rank * 11400714819323198485ull) % n);
+        }
+        return keys;
+    }
+
+    /* Sizes come from the command line, e.g. "./bench 1000000 10000000". */
+    inline std::vector<size_t> sizesFromArgs(int argc, char **argv, const std::vector<size_t>& defaults)
+    {
+        std::vector<size_t> sizes;
+        for (int i = 1; i < argc; ++i)
+            sizes.push_back(std::strtoull(argv[i], NULL, 10));
+        return sizes.empty() ? defaults : sizes;
+    }
+
+    inline void report(const char *name, size_t n, size_t ops, double seconds)
+    {
+        std::printf("%-32s n=%-10zu %8.1f ns/op %10.2f Mops/s\n",
+            name, n, seconds * 1e9 / ops, ops / seconds / 1e6);
+    }
+}
+
+#endif
@@ -0,0 +1,71 @@
+/**
+ * Integer-key lookups: btree_map against RBtree::search on random keys,
+ * with the insert time and bytes per element of both. Vector compares
+ * follow the target: build with -mavx2 (FT_RBTREE_NATIVE in cmake) for
+ * the AVX2 path, since plain x86-64 has no 64-bit vector compare.
+ *   c++ -O2 -std=c++11 -mavx2 bench/btree_search.cpp -o btree_search
+ *   ./btree_search 1000000 10000000
+ */
+
+#include "bench.hpp"
+#include "../btree_map.hpp"
+
+typedef bench::CountingAllocator<bench::pair_type>                                     counting_allocator;
+typedef ft::RBtree<bench::pair_type, std::less<long>, counting_allocator>              rb_tree;
+typedef ft::btree_map<bench::pair_type, std::less<long>, counting_allocator>           b_tree;
+
+static const long *found(const rb_tree::node_type *node) {return node ? &node->value.second : NULL;}
+static const long *found(const bench::pair_type *value) {return value ? &value->second : NULL;}
+
+template<class Tree>
+static double run(const char *name, size_t n, const std::vector<long>& keys, const std::vector<long>& probes)
+{
+    size_t bytesBefore = bench::liveBytes();
+    Tree   tree;
+
+    bench::Timer insert;
+    for (long k : keys)
+        tree.RBTinsert(bench::pair_type(k, k));
+    double insertSeconds = insert.seconds();
+    double bytesPerElement = double(bench::liveBytes() - bytesBefore) / n;
+
+    long         sum = 0;
+    bench::Timer search;
+    for (long k : probes)
+    {
+        const long *value = found(tree.search(k));
+        sum += value ? *value : 0;
+    }
+    double searchSeconds = search.seconds();
+    bench::doNotOptimize(sum);
+
+    std::printf("%-10s n=%-10zu search %7.1f ns/op  insert %7.1f ns/op  %6.1f B/elem\n",
+        name, n, searchSeconds * 1e9 / probes.size(), insertSeconds * 1e9 / n, bytesPerElement);
+    return searchSeconds;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {1000000, 10000000});
+
+    std::printf("btree_map: %u keys per node, %s key search\n", FT_BTREE_KEY_LINES * 64u / unsigned(sizeof(long)),
+#if defined(__AVX2__)
+        "AVX2"
+#elif defined(__SSE4_2__)
+        "SSE4.2"
+#else
+        "scalar"
+#endif
+        );
+    for (size_t n : sizes)
+    {
+        std::vector<long> keys = bench::randomKeys(n);
+        std::vector<long> probes = bench::randomKeys(n, 11);
+        probes.resize(std::min<size_t>(n, 4000000));
+
+        double rb = run<rb_tree>("RBtree", n, keys, probes);
+        double b = run<b_tree>("btree_map", n, keys, probes);
+        std::printf("%-10s n=%-10zu lookups %.2fx faster\n", "", n, rb / b);
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+/**
+ * Building a tree from sorted input: buildFromSorted against one
+ * RBTinsert per element.
+ *   c++ -O2 -std=c++11 bench/bulk_build.cpp -o bulk_build
+ *   ./bulk_build 10000000
+ */
+
+#include "bench.hpp"
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {10000000});
+
+    for (size_t n : sizes)
+    {
+        std::vector<bench::pair_type> values;
+        values.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            values.push_back(bench::pair_type(static_cast<long>(i), static_cast<long>(i)));
+
+        {
+            bench::tree_type tree;
+            bench::Timer t;
+            for (size_t i = 0; i < n; ++i)
+                tree.RBTinsert(values[i]);
+            bench::report("RBTinsert loop", n, n, t.seconds());
+        }
+        {
+            bench::tree_type tree;
+            bench::Timer t;
+            tree.buildFromSorted(values.begin(), values.end());
+            bench::report("buildFromSorted", n, n, t.seconds());
+        }
+        {
+            std::vector<bench::pair_type> shuffled;
+            std::vector<long> keys = bench::randomKeys(n);
+            shuffled.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+                shuffled.push_back(bench::pair_type(keys[i], keys[i]));
+            bench::tree_type tree;
+            bench::Timer t;
+            tree.buildFromRange(shuffled.begin(), shuffled.end());
+            bench::report("buildFromRange (unsorted)", n, n, t.seconds());
+        }
+    }
+    return 0;
+}
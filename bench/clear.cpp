@@ -0,0 +1,37 @@
+/**
+ * Teardown cost: clear() on a tree filled in random order, against
+ * std::map::clear.
+ *   c++ -O2 -std=c++11 bench/clear.cpp -o clear
+ *   ./clear 10000000
+ */
+
+#include <map>
+
+#include "bench.hpp"
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {10000000});
+
+    for (size_t n : sizes)
+    {
+        std::vector<long> keys = bench::randomKeys(n);
+        {
+            bench::tree_type tree;
+            for (long k : keys)
+                tree.RBTinsert(bench::pair_type(k, k));
+            bench::Timer t;
+            tree.clear();
+            bench::report("RBtree clear", n, n, t.seconds());
+        }
+        {
+            std::map<long, long> map;
+            for (long k : keys)
+                map.insert(std::make_pair(k, k));
+            bench::Timer t;
+            map.clear();
+            bench::report("std::map clear", n, n, t.seconds());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * One writer inserting and erasing at full speed against 1 to 64 reader
+ * threads doing lookups, for concurrent_RBtree and for an RBtree behind
+ * a mutex. Reports the readers' total throughput and the latency of a
+ * sample of lookups.
+ *   c++ -O2 -std=c++11 -pthread bench/concurrent_readers.cpp -o concurrent_readers
+ *   ./concurrent_readers 1000000
+ */
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "bench.hpp"
+#include "../concurrent_red_black_tree.hpp"
+
+static const double RUN_SECONDS = 1.0;
+
+struct LockedTree
+{
+    bench::tree_type    tree;
+    std::mutex          mutex;
+
+    bool contains(long k)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return tree.search(k) != NULL;
+    }
+
+    void insert(long k)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tree.RBTinsert(bench::pair_type(k, k));
+    }
+
+    void erase(long k)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tree.RBTdelete(k);
+    }
+};
+
+struct LockFreeTree
+{
+    ft::concurrent_RBtree<bench::pair_type> tree;
+
+    bool contains(long k) {return tree.contains(k);}
+    void insert(long k) {tree.insert(bench::pair_type(k, k));}
+    void erase(long k) {tree.erase(k);}
+};
+
+static double percentile(std::vector<double>& samples, double p)
+{
+    if (samples.empty())
+        return 0;
+    size_t index = static_cast<size_t>(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+template<class Tree>
+static void run(const char *name, size_t n, unsigned readers)
+{
+    Tree tree;
+    std::vector<long> keys = bench::randomKeys(n);
+    for (long k : keys)
+        tree.insert(k);
+
+    std::atomic<bool>                   stop(false);
+    std::vector<size_t>                 lookups(readers);
+    std::vector<std::vector<double> >   samples(readers);
+    std::vector<std::thread>            threads;
+
+    for (unsigned r = 0; r < readers; ++r)
+        threads.emplace_back([&, r] {
+            std::mt19937_64 random(r + 1);
+            size_t          done = 0;
+            size_t          found = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                long k = static_cast<long>(random() % (2 * n));
+                if ((done & 63) == 0)
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    found += tree.contains(k);
+                    samples[r].push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+                }
+                else
+                    found += tree.contains(k);
+                ++done;
+            }
+            bench::doNotOptimize(found);
+            lookups[r] = done;
+        });
+
+    std::mt19937_64 random(0);
+    size_t          writes = 0;
+    bench::Timer    t;
+    while (t.seconds() < RUN_SECONDS)
+    {
+        long k = static_cast<long>(random() % (2 * n));
+        if (writes & 1)
+            tree.erase(k);
+        else
+            tree.insert(k);
+        ++writes;
+    }
+    stop = true;
+    for (std::thread& thread : threads)
+        thread.join();
+    double seconds = t.seconds();
+
+    size_t              total = 0;
+    std::vector<double> all;
+    for (unsigned r = 0; r < readers; ++r)
+    {
+        total += lookups[r];
+        all.insert(all.end(), samples[r].begin(), samples[r].end());
+    }
+    std::printf("%-18s n=%-10zu readers=%-3u %9.2f Mlookups/s  p50 %7.0f ns  p99 %8.0f ns  p99.9 %9.0f ns  writes %8.2f Mops/s\n",
+        name, n, readers, total / seconds / 1e6, percentile(all, 0.5), percentile(all, 0.99),
+        percentile(all, 0.999), writes / seconds / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {1000000});
+
+    for (size_t n : sizes)
+        for (unsigned readers = 1; readers <= 64; readers *= 2)
+        {
+            run<LockedTree>("RBtree + mutex", n, readers);
+            run<LockFreeTree>("concurrent_RBtree", n, readers);
+        }
+    return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * Insert throughput for sorted, near-sorted and random key streams:
+ * plain insert against insert with the previous position as hint.
+ *   c++ -O2 -std=c++11 bench/hinted_insert.cpp -o hinted_insert
+ *   ./hinted_insert 1000000 10000000
+ */
+
+#include "bench.hpp"
+
+/* Sorted keys where about one in ten is swapped with a close neighbour. */
+static std::vector<long> nearSortedKeys(size_t n)
+{
+    std::vector<long> keys = bench::sortedKeys(n);
+    std::mt19937_64 rng(3);
+    for (size_t i = 0; i + 8 < n; i += 10)
+        std::swap(keys[i], keys[i + 1 + rng() % 8]);
+    return keys;
+}
+
+static void run(const char *stream, const std::vector<long>& keys)
+{
+    size_t n = keys.size();
+    std::string plain = std::string(stream) + " insert";
+    std::string hinted = std::string(stream) + " insert(hint)";
+
+    {
+        bench::tree_type tree;
+        bench::Timer t;
+        for (long k : keys)
+            tree.insert(bench::pair_type(k, k));
+        bench::report(plain.c_str(), n, n, t.seconds());
+    }
+    {
+        bench::tree_type tree;
+        bench::tree_type::iterator hint = tree.end();
+        bench::Timer t;
+        for (long k : keys)
+            hint = tree.insert(hint, bench::pair_type(k, k));
+        bench::report(hinted.c_str(), n, n, t.seconds());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {1000000, 10000000});
+
+    for (size_t n : sizes)
+    {
+        run("sorted", bench::sortedKeys(n));
+        run("near-sorted", nearSortedKeys(n));
+        run("random", bench::randomKeys(n));
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * Startup cost of a large map: rebuilding it with RBTinsert against
+ * mapping an image saved with rb_image::save, then querying the image
+ * and converting it to a mutable tree. The file's pages are dropped
+ * from the page cache before it is opened, where the kernel allows.
+ *   c++ -O2 -std=c++11 bench/image_startup.cpp -o image_startup
+ *   ./image_startup 50000000
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bench.hpp"
+#include "../mapped_red_black_tree.hpp"
+
+typedef ft::rb_image<bench::pair_type, std::less<long> >                                image_type;
+typedef ft::mapped_RBtree<bench::pair_type, std::less<long> >                           mapped_type;
+
+static const char *imagePath = "bench_image_startup.img";
+
+static void dropCache(const char *path)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+    ::fsync(fd);
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+static void print(const char *name, size_t n, double seconds)
+{
+    std::printf("%-28s n=%-10zu %10.3f s\n", name, n, seconds);
+}
+
+template<class Map>
+static double lookups(const Map& map, const std::vector<long>& probes)
+{
+    long         sum = 0;
+    bench::Timer t;
+    for (long k : probes)
+    {
+        const bench::pair_type *value = map.search(k);
+        sum += value ? value->second : 0;
+    }
+    double seconds = t.seconds();
+    bench::doNotOptimize(sum);
+    return seconds * 1e9 / probes.size();
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {50000000});
+
+    for (size_t n : sizes)
+    {
+        std::vector<long> keys = bench::randomKeys(n);
+        std::vector<long> probes = bench::randomKeys(n, 11);
+        probes.resize(std::min<size_t>(n, 1000000));
+
+        {
+            bench::tree_type tree;
+            bench::Timer     rebuild;
+            for (long k : keys)
+                tree.RBTinsert(bench::pair_type(k, k));
+            print("rebuild with RBTinsert", n, rebuild.seconds());
+
+            bench::Timer save;
+            image_type::save(tree, imagePath);
+            print("save image", n, save.seconds());
+            std::printf("%-28s n=%-10zu %10.1f B/elem\n", "image size", n,
+                double(sizeof(ft::rb_image_header) + tree.size() * sizeof(image_type::node_type)) / n);
+        }
+        keys = std::vector<long>();
+
+        dropCache(imagePath);
+        {
+            bench::Timer open;
+            image_type   image(imagePath);
+            double       openSeconds = open.seconds();
+            print("open image", n, openSeconds);
+
+            std::vector<long> first(probes.begin(), probes.begin() + std::min<size_t>(n, 1000));
+            bench::Timer      firstLookups;
+            bench::doNotOptimize(lookups(image, first));
+            print("open + 1000 cold lookups", n, openSeconds + firstLookups.seconds());
+            std::printf("%-28s n=%-10zu %10.1f ns/op\n", "image lookup", n, lookups(image, probes));
+        }
+
+        dropCache(imagePath);
+        {
+            bench::Timer convert;
+            mapped_type  map(imagePath);
+            map.tree();
+            print("open + convert to RBtree", n, convert.seconds());
+            std::printf("%-28s n=%-10zu %10.1f ns/op\n", "RBtree lookup", n, lookups(map, probes));
+        }
+        std::remove(imagePath);
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+/**
+ * Time-series ingest: keys arrive in increasing order and the oldest
+ * ones are erased to keep a sliding window. Every write lands on the
+ * cached min or max, which is what the incremental _minMax update helps.
+ *   c++ -O2 -std=c++11 bench/monotonic_ingest.cpp -o monotonic_ingest
+ *   ./monotonic_ingest 1000000 10000000
+ */
+
+#include "bench.hpp"
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {1000000, 10000000});
+
+    for (size_t n : sizes)
+    {
+        bench::tree_type tree;
+        bench::Timer t;
+        for (size_t i = 0; i < n; ++i)
+            tree.RBTinsert(bench::pair_type(static_cast<long>(i), 0));
+        bench::report("increasing insert", n, n, t.seconds());
+
+        /* window of n keys: append one, drop the oldest */
+        bench::Timer w;
+        for (size_t i = 0; i < n; ++i)
+        {
+            tree.RBTinsert(bench::pair_type(static_cast<long>(n + i), 0));
+            tree.RBTdelete(static_cast<long>(i));
+        }
+        bench::report("sliding window insert+erase", n, 2 * n, w.seconds());
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+/**
+ * Insert and lookup throughput of ft::RBtree against std::map.
+ *   c++ -O2 -std=c++11 bench/node_layout.cpp -o node_layout
+ *   ./node_layout 1000000 10000000
+ * To compare with the original layout, which allocated each value
+ * separately, build it again in a scratch directory holding bench/ and
+ * the red_black_tree.hpp of the first commit. That header lacks the
+ * #endif closing its include guard, so append one first:
+ *   git show $(git rev-list --max-parents=0 HEAD):red_black_tree.hpp > old/red_black_tree.hpp
+ *   printf '\n#endif\n' >> old/red_black_tree.hpp && cp -r bench old/
+ *   c++ -O2 -std=c++11 old/bench/node_layout.cpp -o node_layout_old
+ */
+
+#include <map>
+
+#include "bench.hpp"
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {1000000, 10000000});
+
+    for (size_t n : sizes)
+    {
+        std::vector<long> keys = bench::randomKeys(n);
+        std::vector<long> probes = bench::randomKeys(n, 7);
+
+        {
+            bench::tree_type tree;
+            bench::Timer t;
+            for (long k : keys)
+                tree.RBTinsert(bench::pair_type(k, k));
+            bench::report("RBtree insert", n, n, t.seconds());
+
+            bench::Timer s;
+            long sum = 0;
+            for (long k : probes)
+                sum += tree.search(k)->data->second;
+            bench::doNotOptimize(sum);
+            bench::report("RBtree search", n, n, s.seconds());
+        }
+        {
+            std::map<long, long> map;
+            bench::Timer t;
+            for (long k : keys)
+                map.insert(std::make_pair(k, k));
+            bench::report("std::map insert", n, n, t.seconds());
+
+            bench::Timer s;
+            long sum = 0;
+            for (long k : probes)
+                sum += map.find(k)->second;
+            bench::doNotOptimize(sum);
+            bench::report("std::map find", n, n, s.seconds());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+/**
+ * Bytes per element and lookup speed of the compact node layouts: RBtree
+ * with the default and the rb_compact_node layout, indexed_RBtree with
+ * and without reserve(), and std::map, all on random long keys. Bytes
+ * are what the allocator was asked for; per-node allocations also pay
+ * malloc's header and rounding, which the indexed array does not.
+ *   c++ -O2 -std=c++11 bench/node_memory.cpp -o node_memory
+ *   ./node_memory 1000000 10000000
+ */
+
+#include <map>
+
+#include "bench.hpp"
+#include "../indexed_red_black_tree.hpp"
+
+typedef bench::CountingAllocator<bench::pair_type>                                                 counting_allocator;
+typedef ft::RBtree<bench::pair_type, std::less<long>, counting_allocator>                          pointer_tree;
+typedef ft::RBtree<bench::pair_type, std::less<long>, counting_allocator,
+                   ft::rb_no_augment, ft::rb_compact_node>                                         compact_tree;
+typedef ft::indexed_RBtree<bench::pair_type, std::less<long>, counting_allocator>                  indexed_tree;
+typedef std::map<long, long, std::less<long>, counting_allocator>                                  std_map;
+
+static bool found(const pointer_tree& tree, long k) {return tree.search(k) != NULL;}
+static bool found(const compact_tree& tree, long k) {return tree.search(k) != NULL;}
+static bool found(const indexed_tree& tree, long k) {return tree.search(k) != NULL;}
+static bool found(const std_map& tree, long k) {return tree.find(k) != tree.end();}
+
+static void insert(pointer_tree& tree, long k) {tree.RBTinsert(bench::pair_type(k, k));}
+static void insert(compact_tree& tree, long k) {tree.RBTinsert(bench::pair_type(k, k));}
+static void insert(indexed_tree& tree, long k) {tree.RBTinsert(bench::pair_type(k, k));}
+static void insert(std_map& tree, long k) {tree.insert(bench::pair_type(k, k));}
+
+template<class Tree>
+static void reserve(Tree&, size_t) {}
+static void reserve(indexed_tree& tree, size_t n) {tree.reserve(n);}
+
+template<class Tree>
+static void run(const char *name, size_t nodeBytes, size_t n, const std::vector<long>& keys,
+                const std::vector<long>& probes, bool reserved = false)
+{
+    size_t bytesBefore = bench::liveBytes();
+    Tree   tree;
+
+    bench::Timer insertTimer;
+    if (reserved)
+        reserve(tree, n);
+    for (long k : keys)
+        insert(tree, k);
+    double insertSeconds = insertTimer.seconds();
+    double bytesPerElement = double(bench::liveBytes() - bytesBefore) / n;
+
+    size_t       hits = 0;
+    bench::Timer search;
+    for (long k : probes)
+        hits += found(tree, k);
+    double searchSeconds = search.seconds();
+    bench::doNotOptimize(hits);
+
+    char node[16] = "";
+    if (nodeBytes > 0)
+        std::snprintf(node, sizeof(node), "node %3zu B", nodeBytes);
+    std::printf("%-18s n=%-10zu %-10s  %6.1f B/elem  insert %7.1f ns/op  search %7.1f ns/op\n",
+        name, n, node, bytesPerElement, insertSeconds * 1e9 / n, searchSeconds * 1e9 / probes.size());
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {1000000, 10000000});
+
+    for (size_t n : sizes)
+    {
+        std::vector<long> keys = bench::randomKeys(n);
+        std::vector<long> probes = bench::randomKeys(n, 11);
+        probes.resize(std::min<size_t>(n, 4000000));
+
+        run<pointer_tree>("RBtree", sizeof(pointer_tree::node_type), n, keys, probes);
+        run<compact_tree>("RBtree compact", sizeof(compact_tree::node_type), n, keys, probes);
+        run<indexed_tree>("indexed_RBtree", sizeof(indexed_tree::node_type), n, keys, probes);
+        run<indexed_tree>("indexed reserved", sizeof(indexed_tree::node_type), n, keys, probes, true);
+        run<std_map>("std::map", 0, n, keys, probes);
+    }
+    return 0;
+}
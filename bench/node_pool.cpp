@@ -0,0 +1,46 @@
+/**
+ * Insert/erase churn at a steady tree size, and clear(), with
+ * std::allocator against ft::node_pool_allocator.
+ *   c++ -O2 -std=c++11 bench/node_pool.cpp -o node_pool
+ *   ./node_pool 100000 1000000
+ */
+
+#include "bench.hpp"
+
+template<class Tree>
+static void churn(const char *name, size_t n)
+{
+    std::vector<long> keys = bench::randomKeys(2 * n);
+    Tree tree;
+    for (size_t i = 0; i < n; ++i)
+        tree.RBTinsert(typename Tree::value_type(keys[i], keys[i]));
+
+    /* erase the oldest key and insert a new one, so the size stays at n */
+    size_t ops = 4 * n;
+    bench::Timer t;
+    for (size_t i = 0; i < ops; ++i)
+    {
+        tree.RBTdelete(keys[i % (2 * n)]);
+        long k = keys[(i + n) % (2 * n)];
+        tree.RBTinsert(typename Tree::value_type(k, k));
+    }
+    bench::report(name, n, 2 * ops, t.seconds());
+
+    std::string clearName = std::string(name) + " clear";
+    bench::Timer c;
+    tree.clear();
+    bench::report(clearName.c_str(), n, n, c.seconds());
+}
+
+int main(int argc, char **argv)
+{
+    typedef ft::RBtree<bench::pair_type, std::less<long>, ft::node_pool_allocator<bench::pair_type> > pool_tree;
+
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {100000, 1000000});
+    for (size_t n : sizes)
+    {
+        churn<bench::tree_type>("std::allocator churn", n);
+        churn<pool_tree>("node_pool_allocator churn", n);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * Cost of the rb_order_statistic augmentation on inserts and erases,
+ * and select/rank against an in-order walk to the k-th element.
+ *   c++ -O2 -std=c++11 bench/order_statistic.cpp -o order_statistic
+ *   ./order_statistic 1000000
+ */
+
+#include <iterator>
+
+#include "bench.hpp"
+
+typedef ft::RBtree<bench::pair_type, std::less<long>, std::allocator<bench::pair_type>,
+    ft::rb_order_statistic> counted_tree;
+
+template<class Tree>
+static void mutations(const char *name, const std::vector<long>& keys)
+{
+    size_t n = keys.size();
+    Tree tree;
+    std::string insertName = std::string(name) + " insert";
+    std::string eraseName = std::string(name) + " erase";
+
+    bench::Timer t;
+    for (long k : keys)
+        tree.RBTinsert(bench::pair_type(k, k));
+    bench::report(insertName.c_str(), n, n, t.seconds());
+
+    bench::Timer e;
+    for (long k : keys)
+        tree.RBTdelete(k);
+    bench::report(eraseName.c_str(), n, n, e.seconds());
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {1000000});
+
+    for (size_t n : sizes)
+    {
+        std::vector<long> keys = bench::randomKeys(n);
+        mutations<bench::tree_type>("plain", keys);
+        mutations<counted_tree>("order-statistic", keys);
+
+        counted_tree tree;
+        for (long k : keys)
+            tree.RBTinsert(bench::pair_type(k, k));
+
+        size_t queries = 100000;
+        std::vector<long> ranks = bench::randomKeys(queries, 9);
+        long sum = 0;
+        bench::Timer s;
+        for (size_t i = 0; i < queries; ++i)
+            sum += tree.select(static_cast<size_t>(ranks[i]) % n)->value.first;
+        bench::report("select", n, queries, s.seconds());
+
+        bench::Timer r;
+        for (size_t i = 0; i < queries; ++i)
+            sum += static_cast<long>(tree.rank(ranks[i] % static_cast<long>(n)));
+        bench::report("rank", n, queries, r.seconds());
+
+        /* what select replaces: walking to the k-th element */
+        size_t walks = 100;
+        bench::Timer w;
+        for (size_t i = 0; i < walks; ++i)
+        {
+            counted_tree::iterator it = tree.begin();
+            std::advance(it, static_cast<size_t>(ranks[i]) % n);
+            sum += it->first;
+        }
+        bench::report("in-order walk to k", n, walks, w.seconds());
+        bench::doNotOptimize(sum);
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * Fork-join scaling: buildFromSortedParallel, uniteParallel and
+ * intersectParallel with 1, 2, 4, ... threads up to the hardware count.
+ * The set operations combine the multiples of 2 with the multiples of 3.
+ *   c++ -O2 -std=c++11 -pthread bench/parallel.cpp -o parallel
+ *   ./parallel 10000000
+ */
+
+#include <thread>
+
+#include "bench.hpp"
+
+static void fillMultiples(bench::tree_type& tree, size_t n, long step)
+{
+    std::vector<bench::pair_type> values;
+    values.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        values.push_back(bench::pair_type(static_cast<long>(i) * step, static_cast<long>(i)));
+    tree.buildFromSortedParallel(values.begin(), values.end());
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {10000000});
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+
+    for (size_t n : sizes)
+    {
+        std::vector<bench::pair_type> values;
+        values.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+            values.push_back(bench::pair_type(static_cast<long>(i), static_cast<long>(i)));
+
+        for (unsigned threads = 1; threads <= hardware; threads *= 2)
+        {
+            std::string suffix = " x" + std::to_string(threads);
+            {
+                bench::tree_type tree;
+                bench::Timer t;
+                tree.buildFromSortedParallel(values.begin(), values.end(), threads);
+                bench::report(("buildFromSortedParallel" + suffix).c_str(), n, n, t.seconds());
+            }
+            {
+                bench::tree_type a;
+                bench::tree_type b;
+                fillMultiples(a, n / 2, 2);
+                fillMultiples(b, n / 3, 3);
+                bench::Timer t;
+                a.uniteParallel(b, threads);
+                bench::report(("uniteParallel" + suffix).c_str(), n, n / 2 + n / 3, t.seconds());
+            }
+            {
+                bench::tree_type a;
+                bench::tree_type b;
+                fillMultiples(a, n / 2, 2);
+                fillMultiples(b, n / 3, 3);
+                bench::Timer t;
+                a.intersectParallel(b, threads);
+                bench::report(("intersectParallel" + suffix).c_str(), n, n / 2 + n / 3, t.seconds());
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+/**
+ * Point-in-time copies: a deep RBtree copy against a persistent_RBtree
+ * snapshot, in time per copy and in memory held by a copy once the live
+ * tree has taken 10 to 100000 updates since. Also prices the path
+ * copying of a persistent insert against RBTinsert.
+ *   c++ -O2 -std=c++11 bench/snapshot.cpp -o snapshot
+ *   ./snapshot 1000000
+ */
+
+#include "bench.hpp"
+#include "../persistent_red_black_tree.hpp"
+
+typedef bench::CountingAllocator<bench::pair_type>                                     counting_allocator;
+typedef ft::RBtree<bench::pair_type, std::less<long>, counting_allocator>              deep_tree;
+typedef ft::persistent_RBtree<bench::pair_type, std::less<long>, counting_allocator>   persistent_tree;
+
+/* Inserts and erases alternately, so the size stays about the same. */
+template<class Tree, class Insert, class Erase>
+static void churn(Tree& tree, size_t updates, size_t n, Insert insert, Erase erase)
+{
+    std::mt19937_64 random(updates);
+    for (size_t i = 0; i < updates; ++i)
+    {
+        long k = static_cast<long>(random() % (2 * n));
+        if (i & 1)
+            erase(tree, k);
+        else
+            insert(tree, k);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {1000000});
+    const size_t updateCounts[] = {10, 1000, 100000};
+
+    for (size_t n : sizes)
+    {
+        std::vector<long> keys = bench::randomKeys(n);
+        deep_tree         deep;
+        persistent_tree   persistent;
+
+        {
+            bench::Timer t;
+            for (long k : keys)
+                deep.RBTinsert(bench::pair_type(k, k));
+            bench::report("RBtree RBTinsert", n, n, t.seconds());
+        }
+        {
+            bench::Timer t;
+            for (long k : keys)
+                persistent.insert(bench::pair_type(k, k));
+            bench::report("persistent_RBtree insert", n, n, t.seconds());
+        }
+
+        auto deepInsert = [](deep_tree& tree, long k) {tree.RBTinsert(bench::pair_type(k, k));};
+        auto deepErase = [](deep_tree& tree, long k) {tree.RBTdelete(k);};
+        auto persistentInsert = [](persistent_tree& tree, long k) {tree.insert(bench::pair_type(k, k));};
+        auto persistentErase = [](persistent_tree& tree, long k) {tree.erase(k);};
+
+        for (size_t updates : updateCounts)
+        {
+            double seconds;
+            size_t held;
+            {
+                bench::Timer t;
+                deep_tree copy(deep);
+                seconds = t.seconds();
+                churn(deep, updates, n, deepInsert, deepErase);
+                held = bench::liveBytes();
+                copy.clear();
+                held -= bench::liveBytes();
+            }
+            std::printf("%-26s n=%-10zu updates=%-7zu %12.0f ns/copy %14zu bytes held\n",
+                "RBtree deep copy", n, updates, seconds * 1e9, held);
+            {
+                bench::Timer t;
+                persistent_tree copy(persistent.snapshot());
+                seconds = t.seconds();
+                churn(persistent, updates, n, persistentInsert, persistentErase);
+                held = bench::liveBytes();
+                copy.clear();
+                held -= bench::liveBytes();
+            }
+            std::printf("%-26s n=%-10zu updates=%-7zu %12.0f ns/copy %14zu bytes held\n",
+                "persistent_RBtree snapshot", n, updates, seconds * 1e9, held);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * Streaming a tree out and sorted feeds in. Export copies every value
+ * into a 4096-element buffer with batch_cursor, with a recursive walk
+ * and with const_iterator. Ingest builds one tree from 8 sorted runs
+ * with buildFromSortedRuns and with one RBTinsert per element.
+ *   c++ -O2 -std=c++11 bench/sorted_runs.cpp -o sorted_runs
+ *   ./sorted_runs 1000000 10000000
+ */
+
+#include "bench.hpp"
+
+typedef std::pair<long, long>                                                           row_type;
+typedef std::vector<row_type>::const_iterator                                           row_iterator;
+
+static const size_t bufferSize = 4096;
+static const size_t runCount = 8;
+
+/* Stands in for the consumer: folds a full buffer into a checksum. */
+static long consume(const row_type *rows, size_t count)
+{
+    long sum = 0;
+    for (size_t i = 0; i < count; ++i)
+        sum += rows[i].second;
+    return sum;
+}
+
+static void walk(const bench::tree_type::node_type *node, row_type *buffer, size_t& used, long& sum)
+{
+    if (node == NULL)
+        return;
+    walk(node->left, buffer, used, sum);
+    buffer[used++] = node->value;
+    if (used == bufferSize)
+    {
+        sum += consume(buffer, used);
+        used = 0;
+    }
+    walk(node->right, buffer, used, sum);
+}
+
+static void exportTree(size_t n)
+{
+    bench::tree_type  tree;
+    std::vector<long> keys = bench::randomKeys(n);
+    for (long k : keys)
+        tree.RBTinsert(bench::pair_type(k, k));
+
+    std::vector<row_type> buffer(bufferSize);
+    long                  sum = 0;
+    {
+        bench::Timer                   t;
+        bench::tree_type::batch_cursor cursor = tree.cursor();
+        for (size_t got; (got = cursor.read(buffer.begin(), bufferSize)) != 0; )
+            sum += consume(buffer.data(), got);
+        bench::report("export batch_cursor", n, tree.size(), t.seconds());
+    }
+    {
+        bench::Timer t;
+        size_t       used = 0;
+        walk(tree.getRoot(), buffer.data(), used, sum);
+        sum += consume(buffer.data(), used);
+        bench::report("export recursive walk", n, tree.size(), t.seconds());
+    }
+    {
+        bench::Timer t;
+        size_t       used = 0;
+        for (bench::tree_type::const_iterator it = tree.begin(); it != tree.end(); ++it)
+        {
+            buffer[used++] = *it;
+            if (used == bufferSize)
+            {
+                sum += consume(buffer.data(), used);
+                used = 0;
+            }
+        }
+        sum += consume(buffer.data(), used);
+        bench::report("export const_iterator", n, tree.size(), t.seconds());
+    }
+    bench::doNotOptimize(sum);
+}
+
+static void ingestRuns(size_t n)
+{
+    std::vector<std::vector<row_type> > feeds(runCount);
+    std::vector<long>                   keys = bench::randomKeys(n);
+    for (size_t i = 0; i < n; ++i)
+        feeds[i % runCount].push_back(row_type(keys[i], keys[i]));
+    for (size_t r = 0; r < runCount; ++r)
+        std::sort(feeds[r].begin(), feeds[r].end());
+
+    std::vector<std::pair<row_iterator, row_iterator> > runs;
+    for (size_t r = 0; r < runCount; ++r)
+        runs.push_back(std::make_pair(feeds[r].begin(), feeds[r].end()));
+    {
+        bench::tree_type tree;
+        bench::Timer     t;
+        tree.buildFromSortedRuns(runs);
+        bench::report("ingest buildFromSortedRuns", n, n, t.seconds());
+    }
+    {
+        bench::tree_type tree;
+        bench::Timer     t;
+        for (size_t r = 0; r < runCount; ++r)
+            for (row_iterator it = feeds[r].begin(); it != feeds[r].end(); ++it)
+                tree.RBTinsert(bench::pair_type(it->first, it->second));
+        bench::report("ingest RBTinsert", n, n, t.seconds());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {1000000, 10000000});
+
+    for (size_t n : sizes)
+    {
+        exportTree(n);
+        ingestRuns(n);
+    }
+    return 0;
+}
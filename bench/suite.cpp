@@ -0,0 +1,185 @@
+/**
+ * The regression suite: insert, search and erase on random, sorted,
+ * reverse-sorted and Zipfian keys, plus copy, iteration and clear, for
+ * RBtree and std::map side by side. Each line gives ns/op, allocator
+ * calls per op and, after inserting, bytes held per element. Small
+ * sizes are repeated until about a million operations are timed.
+ *   cmake -S . -B build && cmake --build build && ./build/bench_suite 1000 1000000 100000000
+ */
+
+#include <map>
+
+#include "bench.hpp"
+
+typedef bench::CountingAllocator<bench::pair_type>                                     counting_allocator;
+
+struct RBtreeMap
+{
+    typedef ft::RBtree<bench::pair_type, std::less<long>, counting_allocator>  tree_type;
+
+    static const char *name() {return "RBtree";}
+
+    tree_type   tree;
+
+    void    insert(long k) {tree.RBTinsert(bench::pair_type(k, k));}
+    bool    search(long k) const {return tree.search(k) != NULL;}
+    void    erase(long k) {tree.RBTdelete(k);}
+    size_t  size() const {return tree.size();}
+    void    clear() {tree.clear();}
+
+    long    sum() const
+    {
+        long total = 0;
+        for (tree_type::const_iterator it = tree.begin(); it != tree.end(); ++it)
+            total += it->second;
+        return total;
+    }
+};
+
+struct StdMap
+{
+    typedef std::map<long, long, std::less<long>, counting_allocator> tree_type;
+
+    static const char *name() {return "std::map";}
+
+    tree_type   tree;
+
+    void    insert(long k) {tree.insert(bench::pair_type(k, k));}
+    bool    search(long k) const {return tree.find(k) != tree.end();}
+    void    erase(long k) {tree.erase(k);}
+    size_t  size() const {return tree.size();}
+    void    clear() {tree.clear();}
+
+    long    sum() const
+    {
+        long total = 0;
+        for (tree_type::const_iterator it = tree.begin(); it != tree.end(); ++it)
+            total += it->second;
+        return total;
+    }
+};
+
+/* Time, allocator calls and operations summed over the rounds of one measurement. */
+struct Measure
+{
+    double  seconds;
+    size_t  allocations;
+    size_t  ops;
+
+    Measure():seconds(0), allocations(0), ops(0){}
+
+    template<class F>
+    void    run(size_t count, F f)
+    {
+        size_t allocationsBefore = bench::allocationCount();
+        bench::Timer t;
+        f();
+        seconds += t.seconds();
+        allocations += bench::allocationCount() - allocationsBefore;
+        ops += count;
+    }
+};
+
+static void print(const char *structure, const char *op, const char *distribution, size_t n,
+                  const Measure& m, double bytesPerElement)
+{
+    std::printf("%-9s %-7s %-8s n=%-10zu %9.1f ns/op %6.2f allocs/op",
+        structure, op, distribution, n, m.seconds * 1e9 / m.ops, double(m.allocations) / m.ops);
+    if (bytesPerElement > 0)
+        std::printf(" %7.1f B/elem", bytesPerElement);
+    std::printf("\n");
+}
+
+/* Inserts, looks up and erases keys in the order given; probes are the lookups. */
+template<class Map>
+static void runDistribution(const char *distribution, size_t n, const std::vector<long>& keys,
+                            const std::vector<long>& probes, size_t rounds)
+{
+    Measure insert;
+    Measure search;
+    Measure erase;
+    double  bytesPerElement = 0;
+    size_t  found = 0;
+
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        Map    map;
+        size_t bytesBefore = bench::liveBytes();
+
+        insert.run(keys.size(), [&] {
+            for (long k : keys)
+                map.insert(k);
+        });
+        bytesPerElement = double(bench::liveBytes() - bytesBefore) / map.size();
+        search.run(probes.size(), [&] {
+            for (long k : probes)
+                found += map.search(k);
+        });
+        erase.run(keys.size(), [&] {
+            for (long k : keys)
+                map.erase(k);
+        });
+    }
+    bench::doNotOptimize(found);
+    print(Map::name(), "insert", distribution, n, insert, bytesPerElement);
+    print(Map::name(), "search", distribution, n, search, 0);
+    print(Map::name(), "erase", distribution, n, erase, 0);
+}
+
+template<class Map>
+static void runWholeTree(size_t n, const std::vector<long>& keys, size_t rounds)
+{
+    Measure copy;
+    Measure iterate;
+    Measure clear;
+    long    total = 0;
+    Map     map;
+
+    for (long k : keys)
+        map.insert(k);
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        Map duplicate;
+        copy.run(n, [&] {
+            duplicate.tree = map.tree;
+        });
+        iterate.run(n, [&] {
+            total += duplicate.sum();
+        });
+        clear.run(n, [&] {
+            duplicate.clear();
+        });
+    }
+    bench::doNotOptimize(total);
+    print(Map::name(), "copy", "random", n, copy, 0);
+    print(Map::name(), "iterate", "random", n, iterate, 0);
+    print(Map::name(), "clear", "random", n, clear, 0);
+}
+
+template<class Map>
+static void runAll(size_t n)
+{
+    size_t              rounds = std::max<size_t>(1, 1000000 / n);
+    std::vector<long>   random = bench::randomKeys(n);
+    std::vector<long>   sorted = bench::sortedKeys(n);
+    std::vector<long>   reverse = bench::reverseSortedKeys(n);
+    std::vector<long>   zipf = bench::zipfKeys(n, n);
+
+    runDistribution<Map>("random", n, random, bench::randomKeys(n, 11), rounds);
+    runDistribution<Map>("sorted", n, sorted, sorted, rounds);
+    runDistribution<Map>("reverse", n, reverse, reverse, rounds);
+    runDistribution<Map>("zipf", n, zipf, bench::zipfKeys(n, n, 0.99, 11), rounds);
+    runWholeTree<Map>(n, random, rounds);
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = bench::sizesFromArgs(argc, argv, {1000, 100000, 1000000});
+
+    for (size_t n : sizes)
+    {
+        runAll<RBtreeMap>(n);
+        runAll<StdMap>(n);
+    }
+    return 0;
+}
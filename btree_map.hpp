@@ -0,0 +1,860 @@
+#ifndef BTREE_MAP_HPP
+# define BTREE_MAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+# include <immintrin.h>
+#endif
+
+#include "red_black_tree.hpp"
+
+/* Cache lines of keys in each btree_map node. */
+# ifndef FT_BTREE_KEY_LINES
+#  define FT_BTREE_KEY_LINES 4
+# endif
+
+namespace ft{
+
+    /* Number of the n keys below k, one comparison each, no branches. */
+    template<class T>
+    inline unsigned _btree_count_below(const T* keys, unsigned n, T k)
+    {
+        unsigned count = 0;
+        for (unsigned i = 0; i < n; ++i)
+            count += (keys[i] < k);
+        return count;
+    }
+
+    /**
+     * Key search inside a btree_map node for keys the hardware compares
+     * natively: 32 and 64-bit integers, float and double, under
+     * std::less. Slots past the node's count hold pad(), which is never
+     * below a key, so the whole 64-byte aligned block is counted without
+     * looking at the count. NaN keys are not supported.
+     */
+    template<class T, class Enable = void>
+    struct _btree_keys
+    {
+        static const bool simd = false;
+        static T pad() {return T();}
+    };
+
+    template<class T>
+    struct _btree_keys<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value
+        && (sizeof(T) == 4 || sizeof(T) == 8)>::type>
+    {
+        static const bool simd = true;
+        static T pad() {return std::numeric_limits<T>::max();}
+
+        /* Unsigned keys are compared as signed ones with the top bit flipped. */
+        static unsigned countBelow(const T* keys, unsigned n, T k)
+        {
+            return _count(keys, n, k, std::integral_constant<size_t, sizeof(T)>());
+        }
+
+        private:
+            static unsigned _count(const T* keys, unsigned n, T k, std::integral_constant<size_t, 4>)
+            {
+#if defined(__AVX2__)
+                const __m256i flip = _mm256_set1_epi32(std::is_signed<T>::value ? 0 : INT32_MIN);
+                const __m256i key = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(k)), flip);
+                __m256i       below = _mm256_setzero_si256();
+                for (unsigned i = 0; i < n; i += 8)
+                {
+                    __m256i block = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(keys + i)), flip);
+                    below = _mm256_sub_epi32(below, _mm256_cmpgt_epi32(key, block));
+                }
+                __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(below), _mm256_extracti128_si256(below, 1));
+                sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+                sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+                return static_cast<unsigned>(_mm_cvtsi128_si32(sum));
+#elif defined(__SSE2__)
+                const __m128i flip = _mm_set1_epi32(std::is_signed<T>::value ? 0 : INT32_MIN);
+                const __m128i key = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(k)), flip);
+                __m128i       below = _mm_setzero_si128();
+                for (unsigned i = 0; i < n; i += 4)
+                {
+                    __m128i block = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+                    below = _mm_sub_epi32(below, _mm_cmpgt_epi32(key, block));
+                }
+                below = _mm_add_epi32(below, _mm_shuffle_epi32(below, _MM_SHUFFLE(1, 0, 3, 2)));
+                below = _mm_add_epi32(below, _mm_shuffle_epi32(below, _MM_SHUFFLE(2, 3, 0, 1)));
+                return static_cast<unsigned>(_mm_cvtsi128_si32(below));
+#else
+                return _btree_count_below(keys, n, k);
+#endif
+            }
+
+            static unsigned _count(const T* keys, unsigned n, T k, std::integral_constant<size_t, 8>)
+            {
+#if defined(__AVX2__)
+                const __m256i flip = _mm256_set1_epi64x(std::is_signed<T>::value ? 0 : INT64_MIN);
+                const __m256i key = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(k)), flip);
+                __m256i       below = _mm256_setzero_si256();
+                for (unsigned i = 0; i < n; i += 4)
+                {
+                    __m256i block = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(keys + i)), flip);
+                    below = _mm256_sub_epi64(below, _mm256_cmpgt_epi64(key, block));
+                }
+                __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(below), _mm256_extracti128_si256(below, 1));
+                sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+                return static_cast<unsigned>(_mm_cvtsi128_si64(sum));
+#elif defined(__SSE4_2__)
+                const __m128i flip = _mm_set1_epi64x(std::is_signed<T>::value ? 0 : INT64_MIN);
+                const __m128i key = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(k)), flip);
+                __m128i       below = _mm_setzero_si128();
+                for (unsigned i = 0; i < n; i += 2)
+                {
+                    __m128i block = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+                    below = _mm_sub_epi64(below, _mm_cmpgt_epi64(key, block));
+                }
+                below = _mm_add_epi64(below, _mm_unpackhi_epi64(below, below));
+                return static_cast<unsigned>(_mm_cvtsi128_si64(below));
+#else
+                return _btree_count_below(keys, n, k);
+#endif
+            }
+    };
+
+    template<>
+    struct _btree_keys<float>
+    {
+        static const bool simd = true;
+        static float pad() {return std::numeric_limits<float>::infinity();}
+
+        static unsigned countBelow(const float* keys, unsigned n, float k)
+        {
+#if defined(__SSE2__)
+            const __m128 key = _mm_set1_ps(k);
+            __m128i      below = _mm_setzero_si128();
+            for (unsigned i = 0; i < n; i += 4)
+                below = _mm_sub_epi32(below, _mm_castps_si128(_mm_cmplt_ps(_mm_load_ps(keys + i), key)));
+            below = _mm_add_epi32(below, _mm_shuffle_epi32(below, _MM_SHUFFLE(1, 0, 3, 2)));
+            below = _mm_add_epi32(below, _mm_shuffle_epi32(below, _MM_SHUFFLE(2, 3, 0, 1)));
+            return static_cast<unsigned>(_mm_cvtsi128_si32(below));
+#else
+            return _btree_count_below(keys, n, k);
+#endif
+        }
+    };
+
+    template<>
+    struct _btree_keys<double>
+    {
+        static const bool simd = true;
+        static double pad() {return std::numeric_limits<double>::infinity();}
+
+        static unsigned countBelow(const double* keys, unsigned n, double k)
+        {
+#if defined(__AVX2__)
+            const __m256d key = _mm256_set1_pd(k);
+            __m256i       below = _mm256_setzero_si256();
+            for (unsigned i = 0; i < n; i += 4)
+                below = _mm256_sub_epi64(below, _mm256_castpd_si256(_mm256_cmp_pd(_mm256_load_pd(keys + i), key, _CMP_LT_OQ)));
+            __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(below), _mm256_extracti128_si256(below, 1));
+            sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+            return static_cast<unsigned>(_mm_cvtsi128_si64(sum));
+#elif defined(__SSE2__)
+            const __m128d key = _mm_set1_pd(k);
+            __m128i       below = _mm_setzero_si128();
+            for (unsigned i = 0; i < n; i += 2)
+                below = _mm_sub_epi64(below, _mm_castpd_si128(_mm_cmplt_pd(_mm_load_pd(keys + i), key)));
+            below = _mm_add_epi64(below, _mm_unpackhi_epi64(below, below));
+            return static_cast<unsigned>(_mm_cvtsi128_si64(below));
+#else
+            return _btree_count_below(keys, n, k);
+#endif
+        }
+    };
+
+    /* True when btree_map searches keys of type Key ordered by Compare with vector compares. */
+    template<class Key, class Compare>
+    struct btree_simd_key
+    {
+        typedef typename std::remove_const<Key>::type                                       _Key;
+
+        static const bool value = _btree_keys<_Key>::simd
+            && (std::is_same<Compare, std::less<_Key> >::value || std::is_same<Compare, std::less<const _Key> >::value);
+    };
+
+    /**
+     * Ordered map for small keys: a B+-tree whose nodes keep their keys
+     * in FT_BTREE_KEY_LINES 64-byte aligned cache lines, apart from the
+     * values, so a lookup reads a few whole lines per level instead of
+     * one pointer-chasing miss per level. For the keys of btree_simd_key
+     * every line is compared with SSE2 or AVX2, whichever the build
+     * targets; other keys are binary-searched with Compare.
+     *
+     * Key and mapped types must be trivially copyable, since values move
+     * between nodes on splits and merges. Any insert or erase invalidates
+     * iterators and the pointers search returns. The subset of the RBtree
+     * interface it offers behaves the same; ordered_map_engine picks one
+     * of the two by key type. Requires C++11.
+     */
+    template<class Pair, class Compare = std::less<typename Pair::first_type>, class Allocator = std::allocator<Pair> >
+    class btree_map
+    {
+        public:
+            typedef Pair                                                                    value_type;
+            typedef typename std::remove_const<typename Pair::first_type>::type             key_type;
+            typedef typename Pair::second_type                                              mapped_type;
+            typedef size_t                                                                  size_type;
+
+        private:
+            typedef _btree_keys<key_type>                                                   _Keys;
+            typedef std::integral_constant<bool, btree_simd_key<key_type, Compare>::value>  _Simd;
+
+            static_assert(std::is_trivially_copyable<key_type>::value && std::is_trivially_copyable<mapped_type>::value,
+                "btree_map needs trivially copyable keys and values; use RBtree for others");
+
+            static const unsigned _KEYS = FT_BTREE_KEY_LINES * 64 / sizeof(key_type);
+            static const unsigned _MIN_KEYS = _KEYS / 2;
+            /* Nodes other than the root have at least _MIN_KEYS + 1 >= 2 children. */
+            static const int _MAX_HEIGHT = std::numeric_limits<size_type>::digits;
+
+            static_assert(_KEYS >= 4, "FT_BTREE_KEY_LINES is too small for this key type");
+
+            struct _Line
+            {
+                unsigned char                                                               bytes[64];
+            };
+
+            typedef typename Allocator::template rebind<_Line>::other                       line_allocator;
+
+            /* keys sits at offset 0 and nodes start on a line, so the key block is aligned. */
+            struct _Node
+            {
+                key_type                                                                    keys[_KEYS];
+                _Line*                                                                      block;
+                unsigned                                                                    count;
+                bool                                                                        leaf;
+
+                explicit _Node(bool isLeaf):block(NULL), count(0), leaf(isLeaf)
+                {
+                    std::fill(keys, keys + _KEYS, _Keys::pad());
+                }
+            };
+
+            struct _Leaf : _Node
+            {
+                _Leaf*                                                                      prev;
+                _Leaf*                                                                      next;
+                typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type slots[_KEYS];
+
+                _Leaf():_Node(true), prev(NULL), next(NULL){}
+
+                value_type* value(unsigned i) {return reinterpret_cast<value_type*>(&slots[i]);}
+            };
+
+            /* Every key in children[i] is <= keys[i] < every key in children[i + 1]. */
+            struct _Inner : _Node
+            {
+                _Node*                                                                      children[_KEYS + 1];
+
+                _Inner():_Node(false){}
+            };
+
+            static const size_type _LEAF_LINES = (sizeof(_Leaf) + 63) / 64 + 1;
+            static const size_type _INNER_LINES = (sizeof(_Inner) + 63) / 64 + 1;
+
+        public:
+            template<class T>
+            class basic_iterator
+            {
+                public:
+                    typedef std::forward_iterator_tag                                       iterator_category;
+                    typedef T                                                               value_type;
+                    typedef std::ptrdiff_t                                                  difference_type;
+                    typedef T*                                                              pointer;
+                    typedef T&                                                              reference;
+
+                    basic_iterator():_leaf(NULL), _index(0){}
+                    template<class U, class = typename std::enable_if<std::is_same<const U, T>::value && !std::is_const<U>::value>::type>
+                    basic_iterator(const basic_iterator<U>& x):_leaf(x._leaf), _index(x._index){}
+
+                    reference   operator*() const {return *_leaf->value(_index);}
+                    pointer     operator->() const {return _leaf->value(_index);}
+
+                    basic_iterator& operator++()
+                    {
+                        if (++_index == _leaf->count)
+                        {
+                            _leaf = _leaf->next;
+                            _index = 0;
+                        }
+                        return (*this);
+                    }
+
+                    basic_iterator operator++(int) {basic_iterator tmp(*this); ++(*this); return tmp;}
+
+                    template<class U>
+                    bool operator==(const basic_iterator<U>& x) const {return _leaf == x._leaf && _index == x._index;}
+                    template<class U>
+                    bool operator!=(const basic_iterator<U>& x) const {return !(*this == x);}
+
+                private:
+                    friend class btree_map;
+                    template<class> friend class basic_iterator;
+
+                    basic_iterator(_Leaf* leaf, unsigned index):_leaf(leaf), _index(index){}
+
+                    _Leaf*                                                                  _leaf;
+                    unsigned                                                                _index;
+            };
+
+            typedef basic_iterator<value_type>                                              iterator;
+            typedef basic_iterator<const value_type>                                        const_iterator;
+
+            explicit btree_map(const Compare& compare = Compare(), const Allocator& alloc = Allocator())
+                :_root(NULL), _first(NULL), _size(0), _compare(compare), _myLineAlloc(alloc){}
+
+            btree_map(const btree_map& x)
+                :_root(NULL), _first(NULL), _size(0), _compare(x._compare), _myLineAlloc(x._myLineAlloc)
+            {
+                _Leaf* last = NULL;
+                if (x._root != NULL)
+                {
+                    try
+                    {
+                        _root = _clone(x._root, last);
+                    }
+                    catch (...)
+                    {
+                        _freeLeaves();
+                        throw;
+                    }
+                }
+                _size = x._size;
+            }
+
+            btree_map& operator=(const btree_map& x)
+            {
+                if (this != &x)
+                {
+                    btree_map tmp(x);
+                    swap(tmp);
+                }
+                return (*this);
+            }
+
+            ~btree_map(){clear();}
+
+            void swap(btree_map& x)
+            {
+                std::swap(_root, x._root);
+                std::swap(_first, x._first);
+                std::swap(_size, x._size);
+                std::swap(_compare, x._compare);
+                std::swap(_myLineAlloc, x._myLineAlloc);
+            }
+
+            void clear()
+            {
+                if (_root != NULL)
+                    _freeSubtree(_root);
+                _root = NULL;
+                _first = NULL;
+                _size = 0;
+            }
+
+            void RBTinsert(const value_type& val){insert(val);}
+
+            /**
+             * Splits every full node on the way down, so the leaf reached
+             * has room and no split has to climb back up.
+             * Returns the value held for the key and whether it was inserted.
+             */
+            std::pair<value_type*, bool> insert(const value_type& val)
+            {
+                const key_type& k = val.first;
+
+                if (_root == NULL)
+                    _root = _first = _newLeaf();
+                if (_root->count == _KEYS)
+                {
+                    _Inner* root = _newInner();
+                    root->children[0] = _root;
+                    _root = root;
+                    _splitChild(root, 0);
+                }
+                _Node* node = _root;
+                while (!node->leaf)
+                {
+                    _Inner*  inner = static_cast<_Inner*>(node);
+                    unsigned i = _rank(inner, k);
+                    if (inner->children[i]->count == _KEYS)
+                    {
+                        _splitChild(inner, i);
+                        if (_compare(inner->keys[i], k))
+                            ++i;
+                    }
+                    node = inner->children[i];
+                }
+                _Leaf*   leaf = static_cast<_Leaf*>(node);
+                unsigned pos = _rank(leaf, k);
+                if (pos < leaf->count && !_compare(k, leaf->keys[pos]))
+                    return std::make_pair(leaf->value(pos), false);
+                for (unsigned i = leaf->count; i > pos; --i)
+                    _moveValue(leaf, i, leaf, i - 1);
+                leaf->keys[pos] = k;
+                ::new (static_cast<void*>(leaf->value(pos))) value_type(val);
+                ++leaf->count;
+                ++_size;
+                return std::make_pair(leaf->value(pos), true);
+            }
+
+            /**
+             * A node left with fewer than half its keys borrows one from a
+             * sibling, or merges with it when neither can spare one, and
+             * the same check moves up to the parent.
+             */
+            int RBTdelete(const key_type& k)
+            {
+                _Inner*  path[_MAX_HEIGHT];
+                unsigned index[_MAX_HEIGHT];
+                int      depth = 0;
+
+                if (_root == NULL)
+                    return 0;
+                _Node* node = _root;
+                while (!node->leaf)
+                {
+                    _Inner* inner = static_cast<_Inner*>(node);
+                    path[depth] = inner;
+                    index[depth] = _rank(inner, k);
+                    node = inner->children[index[depth++]];
+                }
+                _Leaf*   leaf = static_cast<_Leaf*>(node);
+                unsigned pos = _rank(leaf, k);
+                if (pos == leaf->count || _compare(k, leaf->keys[pos]))
+                    return 0;
+                leaf->value(pos)->~value_type();
+                for (unsigned i = pos + 1; i < leaf->count; ++i)
+                    _moveValue(leaf, i - 1, leaf, i);
+                leaf->keys[--leaf->count] = _Keys::pad();
+                --_size;
+                _rebalance(node, path, index, depth);
+                return 1;
+            }
+
+            /* The value held for k, or NULL. */
+            value_type* search(const key_type& k) {return const_cast<value_type*>(static_cast<const btree_map&>(*this).search(k));}
+
+            const value_type* search(const key_type& k) const
+            {
+                if (_root == NULL)
+                    return NULL;
+                _Leaf*   leaf = _findLeaf(k);
+                unsigned pos = _rank(leaf, k);
+                if (pos == leaf->count || _compare(k, leaf->keys[pos]))
+                    return NULL;
+                return leaf->value(pos);
+            }
+
+            size_type size() const {return _size;}
+            bool isEmpty() const {return _size == 0;}
+
+            iterator        begin() {return iterator(_first, 0);}
+            const_iterator  begin() const {return const_iterator(_first, 0);}
+            iterator        end() {return iterator();}
+            const_iterator  end() const {return const_iterator();}
+
+            /* First element whose key is not less than k. */
+            iterator        lower_bound(const key_type& k) {return _bound(k, false);}
+            const_iterator  lower_bound(const key_type& k) const {return _bound(k, false);}
+
+            /* First element whose key is greater than k. */
+            iterator        upper_bound(const key_type& k) {return _bound(k, true);}
+            const_iterator  upper_bound(const key_type& k) const {return _bound(k, true);}
+
+            /* Calls visit on every value with a key in [lo, hi), in order. */
+            template<class Visitor>
+            Visitor rangeScan(const key_type& lo, const key_type& hi, Visitor visit) const
+            {
+                const_iterator last = end();
+                for (const_iterator it = lower_bound(lo); it != last && _compare(it->first, hi); ++it)
+                    visit(*it);
+                return visit;
+            }
+
+        private:
+            _Node*                                                                          _root;
+            _Leaf*                                                                          _first;
+            size_type                                                                       _size;
+            Compare                                                                         _compare;
+            line_allocator                                                                  _myLineAlloc;
+
+            /* Number of keys in node below k. */
+            unsigned _rank(const _Node* node, const key_type& k) const {return _rank(node, k, _Simd());}
+
+            unsigned _rank(const _Node* node, const key_type& k, std::true_type) const
+            {
+                return _Keys::countBelow(node->keys, _KEYS, k);
+            }
+
+            unsigned _rank(const _Node* node, const key_type& k, std::false_type) const
+            {
+                unsigned low = 0;
+                unsigned high = node->count;
+                while (low < high)
+                {
+                    unsigned middle = (low + high) / 2;
+                    if (_compare(node->keys[middle], k))
+                        low = middle + 1;
+                    else
+                        high = middle;
+                }
+                return low;
+            }
+
+            /* Descends to the leaf where k is or would be, prefetching each next key block. */
+            _Leaf* _findLeaf(const key_type& k) const
+            {
+                _Node* node = _root;
+                while (!node->leaf)
+                {
+                    node = static_cast<_Inner*>(node)->children[_rank(node, k)];
+                    for (unsigned line = 0; line < FT_BTREE_KEY_LINES; ++line)
+                        FT_RBTREE_PREFETCH(reinterpret_cast<const char*>(node->keys) + 64 * line);
+                }
+                return static_cast<_Leaf*>(node);
+            }
+
+            iterator _bound(const key_type& k, bool after) const
+            {
+                if (_root == NULL)
+                    return iterator();
+                _Leaf*   leaf = _findLeaf(k);
+                unsigned pos = _rank(leaf, k);
+                if (after && pos < leaf->count && !_compare(k, leaf->keys[pos]))
+                    ++pos;
+                if (pos == leaf->count)
+                    return iterator(leaf->next, 0);
+                return iterator(leaf, pos);
+            }
+
+            static void _moveValue(_Leaf* to, unsigned i, _Leaf* from, unsigned j)
+            {
+                ::new (static_cast<void*>(to->value(i))) value_type(*from->value(j));
+                from->value(j)->~value_type();
+                to->keys[i] = from->keys[j];
+            }
+
+            template<class N>
+            N* _newNode(size_type lines)
+            {
+                _Line*    block = _myLineAlloc.allocate(lines);
+                uintptr_t address = reinterpret_cast<uintptr_t>(block);
+                N*        node = ::new (reinterpret_cast<void*>((address + 63) & ~uintptr_t(63))) N();
+
+                node->block = block;
+                return node;
+            }
+
+            _Leaf*  _newLeaf() {return _newNode<_Leaf>(_LEAF_LINES);}
+            _Inner* _newInner() {return _newNode<_Inner>(_INNER_LINES);}
+
+            void _freeNode(_Node* node)
+            {
+                _Line* block = node->block;
+                if (node->leaf)
+                {
+                    _Leaf* leaf = static_cast<_Leaf*>(node);
+                    for (unsigned i = 0; i < leaf->count; ++i)
+                        leaf->value(i)->~value_type();
+                    leaf->~_Leaf();
+                    _myLineAlloc.deallocate(block, _LEAF_LINES);
+                }
+                else
+                {
+                    static_cast<_Inner*>(node)->~_Inner();
+                    _myLineAlloc.deallocate(block, _INNER_LINES);
+                }
+            }
+
+            /* The height is logarithmic, so recursion stays shallow. */
+            void _freeSubtree(_Node* node)
+            {
+                if (!node->leaf)
+                {
+                    _Inner* inner = static_cast<_Inner*>(node);
+                    for (unsigned i = 0; i <= inner->count; ++i)
+                        _freeSubtree(inner->children[i]);
+                }
+                _freeNode(node);
+            }
+
+            /* Cleans up a copy that threw halfway: its leaves are all on the list. */
+            void _freeLeaves()
+            {
+                while (_first != NULL)
+                {
+                    _Leaf* next = _first->next;
+                    _freeNode(_first);
+                    _first = next;
+                }
+            }
+
+            /**
+             * Copies leaves in key order, chaining each to last. An inner
+             * node is only linked once all its children are copied, so if
+             * an allocation throws, every inner node made so far is freed
+             * here and the leaves are left on the list for _freeLeaves.
+             */
+            _Node* _clone(const _Node* src, _Leaf*& last)
+            {
+                if (src->leaf)
+                {
+                    const _Leaf* from = static_cast<const _Leaf*>(src);
+                    _Leaf*       leaf = _newLeaf();
+                    std::copy(from->keys, from->keys + _KEYS, leaf->keys);
+                    for (unsigned i = 0; i < from->count; ++i)
+                        ::new (static_cast<void*>(leaf->value(i))) value_type(*const_cast<_Leaf*>(from)->value(i));
+                    leaf->count = from->count;
+                    leaf->prev = last;
+                    if (last == NULL)
+                        _first = leaf;
+                    else
+                        last->next = leaf;
+                    last = leaf;
+                    return leaf;
+                }
+                const _Inner* from = static_cast<const _Inner*>(src);
+                _Inner*       inner = _newInner();
+                unsigned      i = 0;
+                try
+                {
+                    for (; i <= from->count; ++i)
+                        inner->children[i] = _clone(from->children[i], last);
+                }
+                catch (...)
+                {
+                    for (unsigned j = 0; j < i; ++j)
+                        _freeInner(inner->children[j]);
+                    _freeNode(inner);
+                    throw;
+                }
+                std::copy(from->keys, from->keys + _KEYS, inner->keys);
+                inner->count = from->count;
+                return inner;
+            }
+
+            /* Frees the inner nodes of a subtree and none of its leaves. */
+            void _freeInner(_Node* node)
+            {
+                if (node->leaf)
+                    return;
+                _Inner* inner = static_cast<_Inner*>(node);
+                for (unsigned i = 0; i <= inner->count; ++i)
+                    _freeInner(inner->children[i]);
+                _freeNode(inner);
+            }
+
+            /* Splits the full children[i] of parent in two halves and links the right one after it. */
+            void _splitChild(_Inner* parent, unsigned i)
+            {
+                _Node*   child = parent->children[i];
+                unsigned half = _KEYS / 2;
+                _Node*   right;
+                key_type separator;
+
+                if (child->leaf)
+                {
+                    _Leaf* left = static_cast<_Leaf*>(child);
+                    _Leaf* leaf = _newLeaf();
+                    for (unsigned j = half; j < _KEYS; ++j)
+                    {
+                        _moveValue(leaf, j - half, left, j);
+                        left->keys[j] = _Keys::pad();
+                    }
+                    leaf->count = _KEYS - half;
+                    left->count = half;
+                    leaf->prev = left;
+                    leaf->next = left->next;
+                    if (left->next != NULL)
+                        left->next->prev = leaf;
+                    left->next = leaf;
+                    separator = left->keys[half - 1];
+                    right = leaf;
+                }
+                else
+                {
+                    _Inner* left = static_cast<_Inner*>(child);
+                    _Inner* inner = _newInner();
+                    separator = left->keys[half];
+                    for (unsigned j = half + 1; j < _KEYS; ++j)
+                        inner->keys[j - half - 1] = left->keys[j];
+                    for (unsigned j = half + 1; j <= _KEYS; ++j)
+                        inner->children[j - half - 1] = left->children[j];
+                    std::fill(left->keys + half, left->keys + _KEYS, _Keys::pad());
+                    inner->count = _KEYS - half - 1;
+                    left->count = half;
+                    right = inner;
+                }
+                for (unsigned j = parent->count; j > i; --j)
+                {
+                    parent->keys[j] = parent->keys[j - 1];
+                    parent->children[j + 1] = parent->children[j];
+                }
+                parent->keys[i] = separator;
+                parent->children[i + 1] = right;
+                ++parent->count;
+            }
+
+            void _rebalance(_Node* node, _Inner** path, unsigned* index, int depth)
+            {
+                while (depth > 0 && node->count < _MIN_KEYS)
+                {
+                    _Inner*  parent = path[--depth];
+                    unsigned i = index[depth];
+                    _Node*   left = (i > 0) ? parent->children[i - 1] : NULL;
+                    _Node*   right = (i < parent->count) ? parent->children[i + 1] : NULL;
+
+                    if (left != NULL && left->count > _MIN_KEYS)
+                        _borrowFromLeft(parent, i);
+                    else if (right != NULL && right->count > _MIN_KEYS)
+                        _borrowFromRight(parent, i);
+                    else if (left != NULL)
+                        _mergeChildren(parent, i - 1);
+                    else
+                        _mergeChildren(parent, i);
+                    node = parent;
+                }
+                if (_root->count > 0)
+                    return;
+                _Node* old = _root;
+                if (old->leaf)
+                    _root = _first = NULL;
+                else
+                    _root = static_cast<_Inner*>(old)->children[0];
+                _freeNode(old);
+            }
+
+            /* Moves the last entry of children[i - 1] to the front of children[i]. */
+            void _borrowFromLeft(_Inner* parent, unsigned i)
+            {
+                _Node* left = parent->children[i - 1];
+                _Node* node = parent->children[i];
+
+                if (node->leaf)
+                {
+                    _Leaf* from = static_cast<_Leaf*>(left);
+                    _Leaf* to = static_cast<_Leaf*>(node);
+                    for (unsigned j = to->count; j > 0; --j)
+                        _moveValue(to, j, to, j - 1);
+                    _moveValue(to, 0, from, from->count - 1);
+                    parent->keys[i - 1] = from->keys[from->count - 2];
+                }
+                else
+                {
+                    _Inner* from = static_cast<_Inner*>(left);
+                    _Inner* to = static_cast<_Inner*>(node);
+                    for (unsigned j = to->count; j > 0; --j)
+                        to->keys[j] = to->keys[j - 1];
+                    for (unsigned j = to->count + 1; j > 0; --j)
+                        to->children[j] = to->children[j - 1];
+                    to->keys[0] = parent->keys[i - 1];
+                    to->children[0] = from->children[from->count];
+                    parent->keys[i - 1] = from->keys[from->count - 1];
+                }
+                left->keys[--left->count] = _Keys::pad();
+                ++node->count;
+            }
+
+            /* Moves the first entry of children[i + 1] to the end of children[i]. */
+            void _borrowFromRight(_Inner* parent, unsigned i)
+            {
+                _Node* node = parent->children[i];
+                _Node* right = parent->children[i + 1];
+
+                if (node->leaf)
+                {
+                    _Leaf* from = static_cast<_Leaf*>(right);
+                    _Leaf* to = static_cast<_Leaf*>(node);
+                    _moveValue(to, to->count, from, 0);
+                    for (unsigned j = 1; j < from->count; ++j)
+                        _moveValue(from, j - 1, from, j);
+                    parent->keys[i] = to->keys[to->count];
+                }
+                else
+                {
+                    _Inner* from = static_cast<_Inner*>(right);
+                    _Inner* to = static_cast<_Inner*>(node);
+                    to->keys[to->count] = parent->keys[i];
+                    to->children[to->count + 1] = from->children[0];
+                    parent->keys[i] = from->keys[0];
+                    for (unsigned j = 1; j < from->count; ++j)
+                        from->keys[j - 1] = from->keys[j];
+                    for (unsigned j = 1; j <= from->count; ++j)
+                        from->children[j - 1] = from->children[j];
+                }
+                right->keys[--right->count] = _Keys::pad();
+                ++node->count;
+            }
+
+            /* Appends children[i + 1] to children[i] and drops it with its separator. */
+            void _mergeChildren(_Inner* parent, unsigned i)
+            {
+                _Node* left = parent->children[i];
+                _Node* right = parent->children[i + 1];
+
+                if (left->leaf)
+                {
+                    _Leaf* to = static_cast<_Leaf*>(left);
+                    _Leaf* from = static_cast<_Leaf*>(right);
+                    for (unsigned j = 0; j < from->count; ++j)
+                        _moveValue(to, to->count + j, from, j);
+                    to->count += from->count;
+                    to->next = from->next;
+                    if (from->next != NULL)
+                        from->next->prev = to;
+                }
+                else
+                {
+                    _Inner* to = static_cast<_Inner*>(left);
+                    _Inner* from = static_cast<_Inner*>(right);
+                    to->keys[to->count] = parent->keys[i];
+                    for (unsigned j = 0; j < from->count; ++j)
+                        to->keys[to->count + 1 + j] = from->keys[j];
+                    for (unsigned j = 0; j <= from->count; ++j)
+                        to->children[to->count + 1 + j] = from->children[j];
+                    to->count += from->count + 1;
+                }
+                right->count = 0;
+                _freeNode(right);
+                for (unsigned j = i + 1; j < parent->count; ++j)
+                {
+                    parent->keys[j - 1] = parent->keys[j];
+                    parent->children[j] = parent->children[j + 1];
+                }
+                parent->keys[--parent->count] = _Keys::pad();
+            }
+    };
+
+    /**
+     * The faster engine for a map of Pair: btree_map when its keys have a
+     * vector search and its values are trivially copyable, RBtree
+     * otherwise. Code that sticks to the calls both offer (RBTinsert,
+     * insert(...).second, RBTdelete, search(k) != NULL, size, isEmpty,
+     * clear, forward iteration, lower_bound, upper_bound, rangeScan)
+     * works with either.
+     */
+    template<class Pair, class Compare = std::less<typename Pair::first_type>, class Allocator = std::allocator<Pair> >
+    struct ordered_map_engine
+    {
+        typedef typename std::conditional<btree_simd_key<typename Pair::first_type, Compare>::value
+            && std::is_trivially_copyable<typename Pair::second_type>::value,
+            btree_map<Pair, Compare, Allocator>, RBtree<Pair, Compare, Allocator> >::type type;
+    };
+}
+
+#endif
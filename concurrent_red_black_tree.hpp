@@ -0,0 +1,270 @@
+#ifndef CONCURRENT_RED_BLACK_TREE_HPP
+# define CONCURRENT_RED_BLACK_TREE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "path_copy_tree.hpp"
+
+/* Readers that can be inside a concurrent_RBtree at the same time. */
+# ifndef FT_RBTREE_READER_SLOTS
+#  define FT_RBTREE_READER_SLOTS 128
+# endif
+
+/* Retired nodes a writer lets pile up before it looks for ones to free. */
+# ifndef FT_RBTREE_RECLAIM_BATCH
+#  define FT_RBTREE_RECLAIM_BATCH 512
+# endif
+
+namespace ft{
+
+    /**
+     * Ordered map for many readers and serialized writers. Readers take no
+     * lock: a writer never changes a node readers can reach but builds the
+     * new version on copies of the path it touches (see path_copy_tree)
+     * and publishes it by swapping the root. The nodes it replaced are
+     * freed once every reader that started before the swap has left,
+     * which readers announce in a fixed table of epoch slots.
+     *
+     * Pointers a reader gets from read_guard stay valid while the guard
+     * lives. Requires C++11.
+     */
+    template<class Pair, class Compare = std::less<typename Pair::first_type>, class Allocator = std::allocator<Pair> >
+    class concurrent_RBtree : private path_copy_tree<Pair, Compare, Allocator>
+    {
+        private:
+            typedef path_copy_tree<Pair, Compare, Allocator>                                _Base;
+
+        public:
+            typedef typename _Base::value_type                                              value_type;
+            typedef typename _Base::key_type                                                key_type;
+            typedef typename _Base::node_type                                               node_type;
+            typedef typename _Base::size_type                                               size_type;
+
+            /**
+             * Keeps the version seen at construction alive: lookups through
+             * the guard all see that version, and what they return stays
+             * valid until the guard is destroyed.
+             */
+            class read_guard
+            {
+                public:
+                    explicit read_guard(const concurrent_RBtree& tree):_tree(tree), _slot(tree._enter()),
+                        _root(tree._root.load(std::memory_order_seq_cst)){}
+
+                    ~read_guard(){_tree._leave(_slot);}
+
+                    const value_type* search(const key_type& k) const
+                    {
+                        node_type* node = _tree._find(_root, k);
+                        return node ? &node->value : NULL;
+                    }
+
+                private:
+                    read_guard(const read_guard&);
+                    read_guard& operator=(const read_guard&);
+
+                    const concurrent_RBtree&                                                _tree;
+                    size_type                                                               _slot;
+                    node_type*                                                              _root;
+            };
+
+            explicit concurrent_RBtree(const Compare& compare = Compare(), const Allocator& alloc = Allocator())
+                :_Base(compare, alloc), _root(NULL), _size(0), _epoch(1), _retiredHead(0)
+            {
+                for (size_type i = 0; i < FT_RBTREE_READER_SLOTS; ++i)
+                    _slots[i].epoch.store(0, std::memory_order_relaxed);
+            }
+
+            concurrent_RBtree(const concurrent_RBtree&) = delete;
+            concurrent_RBtree& operator=(const concurrent_RBtree&) = delete;
+
+            /* No reader may be left when the tree goes away. */
+            ~concurrent_RBtree()
+            {
+                this->_freeTree(_root.load(std::memory_order_relaxed));
+                for (size_type i = _retiredHead; i < _retired.size(); ++i)
+                    this->_freeNode(_retired[i].node);
+            }
+
+            /* Readers. */
+            bool contains(const key_type& k) const
+            {
+                read_guard guard(*this);
+                return guard.search(k) != NULL;
+            }
+
+            /* Calls f with the value held for k, if any, before returning. */
+            template<class F>
+            bool visit(const key_type& k, F f) const
+            {
+                read_guard        guard(*this);
+                const value_type* value = guard.search(k);
+
+                if (value == NULL)
+                    return false;
+                f(*value);
+                return true;
+            }
+
+            size_type size() const {return _size.load(std::memory_order_relaxed);}
+
+            /* Writers; they take turns on a mutex. */
+            bool insert(const value_type& val)
+            {
+                std::lock_guard<std::mutex> lock(_writer);
+                node_type*                  root = _root.load(std::memory_order_relaxed);
+                bool                        inserted;
+
+                this->_begin();
+                try
+                {
+                    root = this->_insert(root, val, inserted);
+                    if (inserted)
+                        _reserveRetired();
+                }
+                catch (...)
+                {
+                    this->_rollback();
+                    throw;
+                }
+                if (inserted)
+                {
+                    _publish(root);
+                    _size.fetch_add(1, std::memory_order_relaxed);
+                }
+                return inserted;
+            }
+
+            bool erase(const key_type& k)
+            {
+                std::lock_guard<std::mutex> lock(_writer);
+                node_type*                  root = _root.load(std::memory_order_relaxed);
+                bool                        erased;
+
+                this->_begin();
+                try
+                {
+                    root = this->_erase(root, k, erased);
+                    if (erased)
+                        _reserveRetired();
+                }
+                catch (...)
+                {
+                    this->_rollback();
+                    throw;
+                }
+                if (erased)
+                {
+                    _publish(root);
+                    _size.fetch_sub(1, std::memory_order_relaxed);
+                }
+                return erased;
+            }
+
+            /* Frees whatever retired nodes no reader can still see. */
+            void reclaim()
+            {
+                std::lock_guard<std::mutex> lock(_writer);
+                _reclaim();
+            }
+
+        private:
+            struct _Retired
+            {
+                node_type*                                                                  node;
+                uint64_t                                                                    epoch;
+            };
+
+            /* 0 while free, else the epoch its reader entered in. */
+            struct alignas(64) _Slot
+            {
+                std::atomic<uint64_t>                                                       epoch;
+            };
+
+            std::atomic<node_type*>                                                         _root;
+            std::atomic<size_type>                                                          _size;
+            std::atomic<uint64_t>                                                           _epoch;
+            mutable _Slot                                                                   _slots[FT_RBTREE_READER_SLOTS];
+            std::mutex                                                                      _writer;
+            std::vector<_Retired>                                                           _retired;
+            size_type                                                                       _retiredHead;
+
+            /* Claims a free slot, starting from one picked by thread id. */
+            size_type _enter() const
+            {
+                size_type start = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+                for (;;)
+                {
+                    for (size_type i = 0; i < FT_RBTREE_READER_SLOTS; ++i)
+                    {
+                        size_type index = (start + i) % FT_RBTREE_READER_SLOTS;
+                        uint64_t  idle = 0;
+
+                        if (_slots[index].epoch.load(std::memory_order_relaxed) == 0
+                            && _slots[index].epoch.compare_exchange_strong(idle, _epoch.load(std::memory_order_seq_cst)))
+                            return index;
+                    }
+                    std::this_thread::yield();
+                }
+            }
+
+            void _leave(size_type slot) const
+            {
+                _slots[slot].epoch.store(0, std::memory_order_release);
+            }
+
+            void _reserveRetired()
+            {
+                _retired.reserve(_retired.size() + this->_replaced.size());
+            }
+
+            /**
+             * Swaps the new root in. Readers that load it announced their
+             * slot before, with an epoch no older than the one ending here,
+             * so the replaced nodes are retired under that epoch. The nodes
+             * the update made and dropped again were never visible.
+             */
+            void _publish(node_type* root)
+            {
+                _root.store(root, std::memory_order_seq_cst);
+                uint64_t ended = _epoch.fetch_add(1, std::memory_order_seq_cst);
+                for (size_type i = 0; i < this->_replaced.size(); ++i)
+                {
+                    _Retired retired = {this->_replaced[i], ended};
+                    _retired.push_back(retired);
+                }
+                for (size_type i = 0; i < this->_disposed.size(); ++i)
+                    this->_freeNode(this->_disposed[i]);
+                if (_retired.size() - _retiredHead >= FT_RBTREE_RECLAIM_BATCH)
+                    _reclaim();
+            }
+
+            /* _retired is in epoch order, so what can go is a prefix of it. */
+            void _reclaim()
+            {
+                uint64_t oldest = UINT64_MAX;
+                for (size_type i = 0; i < FT_RBTREE_READER_SLOTS; ++i)
+                {
+                    uint64_t epoch = _slots[i].epoch.load(std::memory_order_seq_cst);
+                    if (epoch != 0 && epoch < oldest)
+                        oldest = epoch;
+                }
+                while (_retiredHead < _retired.size() && _retired[_retiredHead].epoch < oldest)
+                    this->_freeNode(_retired[_retiredHead++].node);
+                if (_retiredHead * 2 >= _retired.size())
+                {
+                    _retired.erase(_retired.begin(), _retired.begin() + _retiredHead);
+                    _retiredHead = 0;
+                }
+            }
+    };
+}
+
+#endif
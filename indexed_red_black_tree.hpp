@@ -0,0 +1,699 @@
+#ifndef INDEXED_RED_BLACK_TREE_HPP
+# define INDEXED_RED_BLACK_TREE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ft{
+
+    /**
+     * Node of an indexed_RBtree: 32-bit indices of its children and
+     * parent, 0 meaning none, with the colour in the top bit of parent.
+     * The value lives in raw storage, so free slots stay plain links.
+     */
+    template<class Pair>
+    struct indexed_node
+    {
+        uint32_t                                                                    left;
+        uint32_t                                                                    right;
+        uint32_t                                                                    parent;
+        typename std::aligned_storage<sizeof(Pair), alignof(Pair)>::type            storage;
+
+        Pair&       value() {return *reinterpret_cast<Pair*>(&storage);}
+        const Pair& value() const {return *reinterpret_cast<const Pair*>(&storage);}
+    };
+
+    /**
+     * Red-black tree whose nodes sit in one contiguous array and link to
+     * each other by 32-bit index, so a node costs 12 bytes of links plus
+     * the value: 32 bytes for a pair of longs, against 56 for an RBtree
+     * node (40 with rb_compact_node). It holds up to 2^31 - 1 elements.
+     *
+     * Erased slots are reused before the array grows; growing moves the
+     * values, so an insert invalidates iterators and the pointers search
+     * returns. reserve() avoids that and the slack of doubling. Offers the
+     * same calls as btree_map. Requires C++11.
+     */
+    template<class Pair, class Compare = std::less<typename Pair::first_type>, class Allocator = std::allocator<Pair> >
+    class indexed_RBtree
+    {
+        public:
+            typedef Pair                                                                    value_type;
+            typedef typename Pair::first_type                                               key_type;
+            typedef size_t                                                                  size_type;
+            typedef uint32_t                                                                index_type;
+            typedef ft::indexed_node<Pair>                                                  node_type;
+            typedef typename Allocator::template rebind<node_type>::other                   node_allocator;
+
+            template<class T>
+            class basic_iterator
+            {
+                public:
+                    typedef std::bidirectional_iterator_tag                                 iterator_category;
+                    typedef T                                                               value_type;
+                    typedef std::ptrdiff_t                                                  difference_type;
+                    typedef T*                                                              pointer;
+                    typedef T&                                                              reference;
+
+                    basic_iterator():_tree(NULL), _index(0){}
+                    template<class U, class = typename std::enable_if<std::is_same<const U, T>::value && !std::is_const<U>::value>::type>
+                    basic_iterator(const basic_iterator<U>& x):_tree(x._tree), _index(x._index){}
+
+                    reference   operator*() const {return _tree->_at(_index).value();}
+                    pointer     operator->() const {return &_tree->_at(_index).value();}
+
+                    basic_iterator& operator++() {_index = _tree->_next(_index); return (*this);}
+                    basic_iterator& operator--() {_index = _tree->_prev(_index); return (*this);}
+                    basic_iterator operator++(int) {basic_iterator tmp(*this); ++(*this); return tmp;}
+                    basic_iterator operator--(int) {basic_iterator tmp(*this); --(*this); return tmp;}
+
+                    template<class U>
+                    bool operator==(const basic_iterator<U>& x) const {return _index == x._index;}
+                    template<class U>
+                    bool operator!=(const basic_iterator<U>& x) const {return _index != x._index;}
+
+                private:
+                    friend class indexed_RBtree;
+                    template<class> friend class basic_iterator;
+
+                    basic_iterator(indexed_RBtree* tree, index_type index):_tree(tree), _index(index){}
+
+                    indexed_RBtree*                                                         _tree;
+                    index_type                                                              _index;
+            };
+
+            typedef basic_iterator<value_type>                                              iterator;
+            typedef basic_iterator<const value_type>                                        const_iterator;
+
+            explicit indexed_RBtree(const Compare& compare = Compare(), const Allocator& alloc = Allocator())
+                :_nodes(NULL), _capacity(0), _used(0), _size(0), _root(_NIL), _free(_NIL), _compare(compare), _myNodeAlloc(alloc){}
+
+            /* Copies the array slot for slot, so indices and free slots carry over. */
+            indexed_RBtree(const indexed_RBtree& x)
+                :_nodes(NULL), _capacity(0), _used(0), _size(0), _root(_NIL), _free(_NIL), _compare(x._compare), _myNodeAlloc(x._myNodeAlloc)
+            {
+                _nodes = _relocate(x._nodes, x._used, x._used, false);
+                _capacity = x._used;
+                _used = x._used;
+                _size = x._size;
+                _root = x._root;
+                _free = x._free;
+            }
+
+            indexed_RBtree& operator=(const indexed_RBtree& x)
+            {
+                if (this != &x)
+                {
+                    indexed_RBtree tmp(x);
+                    swap(tmp);
+                }
+                return (*this);
+            }
+
+            ~indexed_RBtree(){clear();}
+
+            void swap(indexed_RBtree& x)
+            {
+                std::swap(_nodes, x._nodes);
+                std::swap(_capacity, x._capacity);
+                std::swap(_used, x._used);
+                std::swap(_size, x._size);
+                std::swap(_root, x._root);
+                std::swap(_free, x._free);
+                std::swap(_compare, x._compare);
+                std::swap(_myNodeAlloc, x._myNodeAlloc);
+            }
+
+            void clear()
+            {
+                _release(_nodes, _capacity, _used);
+                _nodes = NULL;
+                _capacity = 0;
+                _used = 0;
+                _size = 0;
+                _root = _NIL;
+                _free = _NIL;
+            }
+
+            /* Makes room for n elements in all, so inserts up to there never move a value. */
+            void reserve(size_type n)
+            {
+                if (n > _MAX_NODES)
+                    throw std::length_error("indexed_RBtree::reserve");
+                if (n > _capacity)
+                    _grow(n);
+            }
+
+            /**
+             * Moves the elements to the front of an array of exactly size()
+             * slots, renumbering the links, so erased slots are given back
+             * too. Invalidates iterators and pointers; if moving a value
+             * throws, the tree is left as it was.
+             */
+            void shrink_to_fit()
+            {
+                if (_size == 0)
+                {
+                    clear();
+                    return;
+                }
+                if (_size == _capacity)
+                    return;
+
+                std::vector<index_type> renumber(_used + 1, index_type(_NIL));
+                index_type              next = 0;
+                for (size_type i = 0; i < _used; ++i)
+                    if (_nodes[i].right != _FREE)
+                        renumber[i + 1] = ++next;
+
+                node_type* nodes = _myNodeAlloc.allocate(_size);
+                index_type done = 0;
+                try
+                {
+                    for (size_type i = 0; i < _used; ++i)
+                    {
+                        if (_nodes[i].right == _FREE)
+                            continue;
+                        node_type& to = nodes[done];
+                        ::new (static_cast<void*>(&to.storage)) value_type(std::move_if_noexcept(_nodes[i].value()));
+                        ++done;
+                        to.left = renumber[_nodes[i].left];
+                        to.right = renumber[_nodes[i].right];
+                        to.parent = renumber[_nodes[i].parent & ~_RED] | (_nodes[i].parent & _RED);
+                    }
+                }
+                catch (...)
+                {
+                    while (done-- > 0)
+                        nodes[done].value().~value_type();
+                    _myNodeAlloc.deallocate(nodes, _size);
+                    throw;
+                }
+                _release(_nodes, _capacity, _used);
+                _nodes = nodes;
+                _capacity = _size;
+                _used = _size;
+                _root = renumber[_root];
+                _free = _NIL;
+            }
+
+            size_type capacity() const {return _capacity;}
+
+            void RBTinsert(const value_type& val){insert(val);}
+
+            /* Returns the value held for the key and whether it was inserted. */
+            std::pair<value_type*, bool> insert(const value_type& val)
+            {
+                index_type parent = _NIL;
+                bool       toLeft = false;
+
+                for (index_type node = _root; node != _NIL; )
+                {
+                    parent = node;
+                    toLeft = _compare(val.first, _key(node));
+                    if (toLeft)
+                        node = _at(node).left;
+                    else if (_compare(_key(node), val.first))
+                        node = _at(node).right;
+                    else
+                        return std::make_pair(&_at(node).value(), false);
+                }
+                index_type node = _newNode(val);
+                _setParent(node, parent);
+                if (parent == _NIL)
+                    _root = node;
+                else if (toLeft)
+                    _at(parent).left = node;
+                else
+                    _at(parent).right = node;
+                _fixAfterInsert(node);
+                ++_size;
+                return std::make_pair(&_at(node).value(), true);
+            }
+
+            /**
+             * Unlinks the node, or its successor moved into its place, the
+             * way std::map does, then rebalances from the child that took
+             * the removed position, tracking that child's parent since the
+             * child may be none.
+             */
+            int RBTdelete(const key_type& k)
+            {
+                index_type target = _find(k);
+                if (target == _NIL)
+                    return 0;
+
+                index_type removed = target;
+                index_type child;
+                index_type childParent;
+
+                if (_at(target).left == _NIL)
+                    child = _at(target).right;
+                else if (_at(target).right == _NIL)
+                    child = _at(target).left;
+                else
+                {
+                    removed = _at(target).right;
+                    while (_at(removed).left != _NIL)
+                        removed = _at(removed).left;
+                    child = _at(removed).right;
+                }
+                if (removed != target)
+                {
+                    _setParent(_at(target).left, removed);
+                    _at(removed).left = _at(target).left;
+                    if (removed != _at(target).right)
+                    {
+                        childParent = _parent(removed);
+                        _setParent(child, childParent);
+                        _at(childParent).left = child;
+                        _at(removed).right = _at(target).right;
+                        _setParent(_at(target).right, removed);
+                    }
+                    else
+                        childParent = removed;
+                    _replaceChild(target, removed);
+                    _setParent(removed, _parent(target));
+                    bool color = _isRed(removed);
+                    _setRed(removed, _isRed(target));
+                    _setRed(target, color);
+                }
+                else
+                {
+                    childParent = _parent(target);
+                    _setParent(child, childParent);
+                    _replaceChild(target, child);
+                }
+                if (!_isRed(target))
+                    _fixAfterErase(child, childParent);
+                _freeNode(target);
+                --_size;
+                return 1;
+            }
+
+            /* The value held for k, or NULL. */
+            value_type* search(const key_type& k)
+            {
+                index_type node = _find(k);
+                return (node == _NIL) ? NULL : &_at(node).value();
+            }
+
+            const value_type* search(const key_type& k) const
+            {
+                index_type node = _find(k);
+                return (node == _NIL) ? NULL : &_at(node).value();
+            }
+
+            size_type size() const {return _size;}
+            bool isEmpty() const {return _size == 0;}
+
+            iterator        begin() {return iterator(this, _first(_root));}
+            const_iterator  begin() const {return const_iterator(_self(), _first(_root));}
+            iterator        end() {return iterator(this, _NIL);}
+            const_iterator  end() const {return const_iterator(_self(), _NIL);}
+
+            /* First element whose key is not less than k. */
+            iterator        lower_bound(const key_type& k) {return iterator(this, _bound(k, false));}
+            const_iterator  lower_bound(const key_type& k) const {return const_iterator(_self(), _bound(k, false));}
+
+            /* First element whose key is greater than k. */
+            iterator        upper_bound(const key_type& k) {return iterator(this, _bound(k, true));}
+            const_iterator  upper_bound(const key_type& k) const {return const_iterator(_self(), _bound(k, true));}
+
+            /* Calls visit on every value with a key in [lo, hi), in order. */
+            template<class Visitor>
+            Visitor rangeScan(const key_type& lo, const key_type& hi, Visitor visit) const
+            {
+                for (index_type node = _bound(lo, false); node != _NIL && _compare(_key(node), hi); node = _next(node))
+                    visit(_at(node).value());
+                return visit;
+            }
+
+            /**
+             * O(n) check of the red-black properties, the parent links, the
+             * key order and size(); true when all of them hold.
+             */
+            bool checkInvariants() const
+            {
+                if (_root != _NIL && (_isRed(_root) || _parent(_root) != _NIL))
+                    return false;
+                size_type count = 0;
+                int       blackHeight = -1;
+                for (index_type node = _first(_root); node != _NIL; node = _next(node))
+                {
+                    ++count;
+                    index_type next = _next(node);
+                    if (next != _NIL && !_compare(_key(node), _key(next)))
+                        return false;
+                    const index_type children[2] = {_at(node).left, _at(node).right};
+                    for (int i = 0; i < 2; ++i)
+                    {
+                        if (children[i] != _NIL)
+                        {
+                            if (_parent(children[i]) != node || (_isRed(node) && _isRed(children[i])))
+                                return false;
+                            continue;
+                        }
+                        int blacks = 0;
+                        for (index_type up = node; up != _NIL; up = _parent(up))
+                            blacks += !_isRed(up);
+                        if (blackHeight == -1)
+                            blackHeight = blacks;
+                        else if (blacks != blackHeight)
+                            return false;
+                    }
+                }
+                return count == _size;
+            }
+
+        private:
+            static const index_type _NIL = 0;
+            static const index_type _RED = 0x80000000u;
+            /* A slot on the free list has this as right, and the next free slot as left. */
+            static const index_type _FREE = 0xFFFFFFFFu;
+            static const size_type  _MAX_NODES = 0x7FFFFFFFu;
+
+            node_type*                                                                      _nodes;
+            size_type                                                                       _capacity;
+            size_type                                                                       _used;
+            size_type                                                                       _size;
+            index_type                                                                      _root;
+            index_type                                                                      _free;
+            Compare                                                                         _compare;
+            node_allocator                                                                  _myNodeAlloc;
+
+            indexed_RBtree* _self() const {return const_cast<indexed_RBtree*>(this);}
+
+            /* Slot i is _nodes[i - 1], so 0 can mean none. */
+            node_type& _at(index_type i) const {return _nodes[i - 1];}
+            const key_type& _key(index_type i) const {return _at(i).value().first;}
+
+            index_type _parent(index_type i) const {return _at(i).parent & ~_RED;}
+
+            void _setParent(index_type i, index_type parent)
+            {
+                if (i != _NIL)
+                    _at(i).parent = (_at(i).parent & _RED) | parent;
+            }
+
+            bool _isRed(index_type i) const {return i != _NIL && (_at(i).parent & _RED) != 0;}
+
+            void _setRed(index_type i, bool red)
+            {
+                if (i != _NIL)
+                    _at(i).parent = red ? (_at(i).parent | _RED) : (_at(i).parent & ~_RED);
+            }
+
+            index_type _find(const key_type& k) const
+            {
+                index_type node = _bound(k, false);
+                return (node != _NIL && !_compare(k, _key(node))) ? node : _NIL;
+            }
+
+            index_type _bound(const key_type& k, bool after) const
+            {
+                index_type result = _NIL;
+                for (index_type node = _root; node != _NIL; )
+                {
+                    if (after ? _compare(k, _key(node)) : !_compare(_key(node), k))
+                    {
+                        result = node;
+                        node = _at(node).left;
+                    }
+                    else
+                        node = _at(node).right;
+                }
+                return result;
+            }
+
+            index_type _first(index_type node) const
+            {
+                if (node != _NIL)
+                    while (_at(node).left != _NIL)
+                        node = _at(node).left;
+                return node;
+            }
+
+            index_type _last(index_type node) const
+            {
+                if (node != _NIL)
+                    while (_at(node).right != _NIL)
+                        node = _at(node).right;
+                return node;
+            }
+
+            index_type _next(index_type node) const
+            {
+                if (_at(node).right != _NIL)
+                    return _first(_at(node).right);
+                index_type parent = _parent(node);
+                while (parent != _NIL && node == _at(parent).right)
+                {
+                    node = parent;
+                    parent = _parent(node);
+                }
+                return parent;
+            }
+
+            /* The end has the largest element before it. */
+            index_type _prev(index_type node) const
+            {
+                if (node == _NIL)
+                    return _last(_root);
+                if (_at(node).left != _NIL)
+                    return _last(_at(node).left);
+                index_type parent = _parent(node);
+                while (parent != _NIL && node == _at(parent).left)
+                {
+                    node = parent;
+                    parent = _parent(node);
+                }
+                return parent;
+            }
+
+            /* Points node's parent, or the root, at replacement instead of node. */
+            void _replaceChild(index_type node, index_type replacement)
+            {
+                index_type parent = _parent(node);
+                if (parent == _NIL)
+                    _root = replacement;
+                else if (_at(parent).left == node)
+                    _at(parent).left = replacement;
+                else
+                    _at(parent).right = replacement;
+            }
+
+            void _rotateLeft(index_type node)
+            {
+                index_type child = _at(node).right;
+
+                _at(node).right = _at(child).left;
+                _setParent(_at(child).left, node);
+                _setParent(child, _parent(node));
+                _replaceChild(node, child);
+                _at(child).left = node;
+                _setParent(node, child);
+            }
+
+            void _rotateRight(index_type node)
+            {
+                index_type child = _at(node).left;
+
+                _at(node).left = _at(child).right;
+                _setParent(_at(child).right, node);
+                _setParent(child, _parent(node));
+                _replaceChild(node, child);
+                _at(child).right = node;
+                _setParent(node, child);
+            }
+
+            void _fixAfterInsert(index_type node)
+            {
+                while (node != _root && _isRed(_parent(node)))
+                {
+                    index_type parent = _parent(node);
+                    index_type grandfather = _parent(parent);
+                    bool       leftSide = (parent == _at(grandfather).left);
+                    index_type uncle = leftSide ? _at(grandfather).right : _at(grandfather).left;
+
+                    if (_isRed(uncle))
+                    {
+                        _setRed(parent, false);
+                        _setRed(uncle, false);
+                        _setRed(grandfather, true);
+                        node = grandfather;
+                        continue;
+                    }
+                    if (node == (leftSide ? _at(parent).right : _at(parent).left))
+                    {
+                        node = parent;
+                        if (leftSide)
+                            _rotateLeft(node);
+                        else
+                            _rotateRight(node);
+                        parent = _parent(node);
+                    }
+                    _setRed(parent, false);
+                    _setRed(grandfather, true);
+                    if (leftSide)
+                        _rotateRight(grandfather);
+                    else
+                        _rotateLeft(grandfather);
+                }
+                _setRed(_root, false);
+            }
+
+            /* node carries an extra black; it may be none, so parent is passed along. */
+            void _fixAfterErase(index_type node, index_type parent)
+            {
+                while (node != _root && !_isRed(node))
+                {
+                    bool       leftSide = (node == _at(parent).left);
+                    index_type sibling = leftSide ? _at(parent).right : _at(parent).left;
+
+                    if (_isRed(sibling))
+                    {
+                        _setRed(sibling, false);
+                        _setRed(parent, true);
+                        if (leftSide)
+                            _rotateLeft(parent);
+                        else
+                            _rotateRight(parent);
+                        sibling = leftSide ? _at(parent).right : _at(parent).left;
+                    }
+                    index_type nearNephew = leftSide ? _at(sibling).left : _at(sibling).right;
+                    index_type farNephew = leftSide ? _at(sibling).right : _at(sibling).left;
+                    if (!_isRed(nearNephew) && !_isRed(farNephew))
+                    {
+                        _setRed(sibling, true);
+                        node = parent;
+                        parent = _parent(node);
+                        continue;
+                    }
+                    if (!_isRed(farNephew))
+                    {
+                        _setRed(nearNephew, false);
+                        _setRed(sibling, true);
+                        if (leftSide)
+                            _rotateRight(sibling);
+                        else
+                            _rotateLeft(sibling);
+                        sibling = leftSide ? _at(parent).right : _at(parent).left;
+                        farNephew = leftSide ? _at(sibling).right : _at(sibling).left;
+                    }
+                    _setRed(sibling, _isRed(parent));
+                    _setRed(parent, false);
+                    _setRed(farNephew, false);
+                    if (leftSide)
+                        _rotateLeft(parent);
+                    else
+                        _rotateRight(parent);
+                    node = _root;
+                }
+                _setRed(node, false);
+            }
+
+            /* Takes a free slot, else the next unused one, else doubles the array. */
+            index_type _newNode(const value_type& val)
+            {
+                index_type node;
+
+                if (_free != _NIL)
+                {
+                    node = _free;
+                    ::new (static_cast<void*>(&_at(node).storage)) value_type(val);
+                    _free = _at(node).left;
+                }
+                else
+                {
+                    if (_used == _capacity)
+                    {
+                        if (_capacity == _MAX_NODES)
+                            throw std::length_error("indexed_RBtree::insert");
+                        _grow((_capacity < _MAX_NODES / 2) ? std::max<size_type>(2 * _capacity, 16) : _MAX_NODES);
+                    }
+                    node = static_cast<index_type>(_used + 1);
+                    ::new (static_cast<void*>(&_at(node).storage)) value_type(val);
+                    ++_used;
+                }
+                _at(node).left = _NIL;
+                _at(node).right = _NIL;
+                _at(node).parent = _RED;
+                return node;
+            }
+
+            void _freeNode(index_type node)
+            {
+                _at(node).value().~value_type();
+                _at(node).left = _free;
+                _at(node).right = _FREE;
+                _free = node;
+            }
+
+            void _grow(size_type capacity)
+            {
+                node_type* nodes = _relocate(_nodes, _used, capacity, true);
+                _release(_nodes, _capacity, _used);
+                _nodes = nodes;
+                _capacity = capacity;
+            }
+
+            /**
+             * A new array of capacity slots holding the first used slots of
+             * from. Values are moved when that cannot throw and move is
+             * asked for, copied otherwise; a throwing copy leaves from as
+             * it was.
+             */
+            node_type* _relocate(node_type* from, size_type used, size_type capacity, bool move)
+            {
+                if (capacity == 0)
+                    return NULL;
+                node_type* nodes = _myNodeAlloc.allocate(capacity);
+                size_type  i = 0;
+                try
+                {
+                    for (; i < used; ++i)
+                    {
+                        nodes[i].left = from[i].left;
+                        nodes[i].right = from[i].right;
+                        nodes[i].parent = from[i].parent;
+                        if (from[i].right == _FREE)
+                            continue;
+                        if (move)
+                            ::new (static_cast<void*>(&nodes[i].storage)) value_type(std::move_if_noexcept(from[i].value()));
+                        else
+                            ::new (static_cast<void*>(&nodes[i].storage)) value_type(from[i].value());
+                    }
+                }
+                catch (...)
+                {
+                    while (i-- > 0)
+                        if (nodes[i].right != _FREE)
+                            nodes[i].value().~value_type();
+                    _myNodeAlloc.deallocate(nodes, capacity);
+                    throw;
+                }
+                return nodes;
+            }
+
+            void _release(node_type* nodes, size_type capacity, size_type used)
+            {
+                if (nodes == NULL)
+                    return;
+                for (size_type i = 0; i < used; ++i)
+                    if (nodes[i].right != _FREE)
+                        nodes[i].value().~value_type();
+                _myNodeAlloc.deallocate(nodes, capacity);
+            }
+    };
+}
+
+#endif
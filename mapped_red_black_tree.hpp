@@ -0,0 +1,535 @@
+#ifndef MAPPED_RED_BLACK_TREE_HPP
+# define MAPPED_RED_BLACK_TREE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "red_black_tree.hpp"
+
+namespace ft{
+
+    /**
+     * First 64 bytes of an image file. The nodes start at nodesOffset
+     * and are stored in key order, so a node's index is its rank and
+     * links are indices, valid wherever the file is mapped.
+     */
+    struct rb_image_header
+    {
+        char                                                                            magic[8];
+        uint32_t                                                                        version;
+        /* 0x01020304 as the writer stored it, so a file from another byte order is refused. */
+        uint32_t                                                                        byteOrder;
+        uint64_t                                                                        valueSize;
+        uint64_t                                                                        nodeSize;
+        uint64_t                                                                        count;
+        /* Index + 1 of the root, 0 when empty. */
+        uint64_t                                                                        root;
+        uint64_t                                                                        nodesOffset;
+    };
+
+    /* left and right are index + 1 of each child, 0 for none; the top bit of left is set on red nodes. */
+    template<class Pair>
+    struct rb_image_node
+    {
+        uint32_t                                                                        left;
+        uint32_t                                                                        right;
+        Pair                                                                            value;
+    };
+
+    /**
+     * Read-only view of an RBtree saved with save(): the file is mapped
+     * and queried in place, so opening one costs no allocation and no
+     * rebalancing, and only the pages a query touches are read from
+     * disk. The image keeps the saved tree's shape and colours, and its
+     * nodes sit in key order, so iterators are random access.
+     *
+     * Key and mapped types must be trivially copyable, and a file is
+     * only read back by a build with the same value layout and byte
+     * order; the header is checked on open, the nodes are not (see
+     * checkInvariants). Holds up to 2^31 - 1 elements. Requires C++11
+     * and POSIX mmap.
+     */
+    template<class Pair, class Compare = std::less<typename std::remove_const<typename Pair::first_type>::type> >
+    class rb_image
+    {
+        public:
+            typedef Pair                                                                    value_type;
+            typedef typename std::remove_const<typename Pair::first_type>::type             key_type;
+            typedef typename Pair::second_type                                              mapped_type;
+            typedef size_t                                                                  size_type;
+            typedef rb_image_node<Pair>                                                     node_type;
+
+            static_assert(std::is_trivially_copyable<key_type>::value && std::is_trivially_copyable<mapped_type>::value,
+                "rb_image needs trivially copyable keys and values");
+            static_assert(alignof(node_type) <= 64, "rb_image nodes must fit the 64-byte header alignment");
+
+            class const_iterator
+            {
+                public:
+                    typedef std::random_access_iterator_tag                                 iterator_category;
+                    typedef const Pair                                                      value_type;
+                    typedef std::ptrdiff_t                                                  difference_type;
+                    typedef const Pair*                                                     pointer;
+                    typedef const Pair&                                                     reference;
+
+                    const_iterator():_node(NULL){}
+
+                    reference   operator*() const {return _node->value;}
+                    pointer     operator->() const {return &_node->value;}
+                    reference   operator[](difference_type n) const {return _node[n].value;}
+
+                    const_iterator& operator++() {++_node; return (*this);}
+                    const_iterator& operator--() {--_node; return (*this);}
+                    const_iterator operator++(int) {const_iterator tmp(*this); ++_node; return tmp;}
+                    const_iterator operator--(int) {const_iterator tmp(*this); --_node; return tmp;}
+                    const_iterator& operator+=(difference_type n) {_node += n; return (*this);}
+                    const_iterator& operator-=(difference_type n) {_node -= n; return (*this);}
+                    const_iterator operator+(difference_type n) const {return const_iterator(_node + n);}
+                    const_iterator operator-(difference_type n) const {return const_iterator(_node - n);}
+                    difference_type operator-(const const_iterator& x) const {return _node - x._node;}
+
+                    bool operator==(const const_iterator& x) const {return _node == x._node;}
+                    bool operator!=(const const_iterator& x) const {return _node != x._node;}
+                    bool operator<(const const_iterator& x) const {return _node < x._node;}
+
+                private:
+                    friend class rb_image;
+
+                    explicit const_iterator(const node_type* node):_node(node){}
+
+                    const node_type*                                                        _node;
+            };
+
+            rb_image():_base(NULL), _length(0), _nodes(NULL), _size(0), _root(0), _compare(){}
+
+            /* Maps path read-only; throws std::runtime_error if it cannot be opened or is not an image of this type. */
+            explicit rb_image(const char* path, const Compare& compare = Compare())
+                :_base(NULL), _length(0), _nodes(NULL), _size(0), _root(0), _compare(compare)
+            {
+                _Fd fd(::open(path, O_RDONLY));
+                struct stat st;
+                if (fd.fd < 0 || ::fstat(fd.fd, &st) != 0)
+                    _fail("cannot open", path);
+                if (static_cast<uint64_t>(st.st_size) < sizeof(rb_image_header))
+                    _invalid(path);
+                _length = static_cast<size_t>(st.st_size);
+                void* base = ::mmap(NULL, _length, PROT_READ, MAP_PRIVATE, fd.fd, 0);
+                if (base == MAP_FAILED)
+                    _fail("cannot map", path);
+                _base = base;
+
+                const rb_image_header* header = static_cast<const rb_image_header*>(_base);
+                if (std::memcmp(header->magic, _magic(), sizeof(header->magic)) != 0 || header->version != _VERSION
+                    || header->byteOrder != _BYTE_ORDER || header->valueSize != sizeof(value_type)
+                    || header->nodeSize != sizeof(node_type) || header->nodesOffset % alignof(node_type) != 0
+                    || header->count > _MAX_NODES || header->root > header->count
+                    || header->nodesOffset > _length || (_length - header->nodesOffset) / sizeof(node_type) < header->count)
+                {
+                    _unmap();
+                    _invalid(path);
+                }
+                _nodes = reinterpret_cast<const node_type*>(static_cast<const char*>(_base) + header->nodesOffset);
+                _size = static_cast<size_type>(header->count);
+                _root = static_cast<uint32_t>(header->root);
+            }
+
+            rb_image(rb_image&& x) noexcept:_base(x._base), _length(x._length), _nodes(x._nodes), _size(x._size), _root(x._root), _compare(x._compare)
+            {
+                x._base = NULL;
+                x._release();
+            }
+
+            rb_image& operator=(rb_image&& x) noexcept
+            {
+                if (this != &x)
+                {
+                    _unmap();
+                    _base = x._base;
+                    _length = x._length;
+                    _nodes = x._nodes;
+                    _size = x._size;
+                    _root = x._root;
+                    _compare = x._compare;
+                    x._base = NULL;
+                    x._release();
+                }
+                return (*this);
+            }
+
+            rb_image(const rb_image&) = delete;
+            rb_image& operator=(const rb_image&) = delete;
+
+            ~rb_image(){_unmap();}
+
+            /**
+             * Writes tree to path: the nodes in key order with their links
+             * and colours, then the header. The image is built in
+             * path.tmp through a shared mapping, synced to disk and renamed
+             * over path, so a crash leaves the previous file whole, and an
+             * image mapped from path keeps reading the old file.
+             */
+            template<class Alloc, class Augment, class Layout>
+            static void save(const RBtree<Pair, Compare, Alloc, Augment, Layout>& tree, const char* path)
+            {
+                if (tree.size() > _MAX_NODES)
+                    throw std::length_error("rb_image::save");
+                _TempFile file(path);
+                size_t    length = _HEADER_SIZE + tree.size() * sizeof(node_type);
+                if (::ftruncate(file.fd.fd, static_cast<off_t>(length)) != 0)
+                    _fail("cannot size", file.path.c_str());
+                void* base = ::mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd.fd, 0);
+                if (base == MAP_FAILED)
+                    _fail("cannot map", file.path.c_str());
+
+                node_type* nodes = reinterpret_cast<node_type*>(static_cast<char*>(base) + _HEADER_SIZE);
+                uint32_t   next = 0;
+                uint32_t   root = _write(tree.getRoot(), nodes, next);
+
+                rb_image_header header;
+                std::memset(&header, 0, sizeof(header));
+                std::memcpy(header.magic, _magic(), sizeof(header.magic));
+                header.version = _VERSION;
+                header.byteOrder = _BYTE_ORDER;
+                header.valueSize = sizeof(value_type);
+                header.nodeSize = sizeof(node_type);
+                header.count = tree.size();
+                header.root = root;
+                header.nodesOffset = _HEADER_SIZE;
+                std::memcpy(base, &header, sizeof(header));
+                bool synced = (::msync(base, length, MS_SYNC) == 0);
+                ::munmap(base, length);
+                if (!synced)
+                    _fail("cannot write", file.path.c_str());
+                file.commit();
+            }
+
+            /* Writes the mapped file as it is to path, the same way; path may be the file it was mapped from. */
+            void save(const char* path) const
+            {
+                _TempFile file(path);
+                for (size_t done = 0; done < _length; )
+                {
+                    ssize_t n = ::write(file.fd.fd, static_cast<const char*>(_base) + done, _length - done);
+                    if (n < 0 && errno != EINTR)
+                        _fail("cannot write", file.path.c_str());
+                    done += (n > 0) ? static_cast<size_t>(n) : 0;
+                }
+                file.commit();
+            }
+
+            /* The value held for k, or NULL. */
+            const value_type* search(const key_type& k) const
+            {
+                const node_type* node = _lowerBound(k);
+                return (node != _end() && !_compare(k, node->value.first)) ? &node->value : NULL;
+            }
+
+            size_type size() const {return _size;}
+            bool isEmpty() const {return _size == 0;}
+
+            const_iterator  begin() const {return const_iterator(_nodes);}
+            const_iterator  end() const {return const_iterator(_end());}
+
+            /* First element whose key is not less than k. */
+            const_iterator  lower_bound(const key_type& k) const {return const_iterator(_lowerBound(k));}
+
+            /* First element whose key is greater than k. */
+            const_iterator  upper_bound(const key_type& k) const
+            {
+                const node_type* result = _end();
+                for (uint32_t i = _root; i != 0; )
+                {
+                    const node_type& node = _nodes[i - 1];
+                    if (_compare(k, node.value.first))
+                    {
+                        result = &node;
+                        i = node.left & ~_RED;
+                    }
+                    else
+                        i = node.right;
+                }
+                return const_iterator(result);
+            }
+
+            /* Calls visit on every value with a key in [lo, hi), in order. */
+            template<class Visitor>
+            Visitor rangeScan(const key_type& lo, const key_type& hi, Visitor visit) const
+            {
+                for (const node_type* node = _lowerBound(lo); node != _end() && _compare(node->value.first, hi); ++node)
+                    visit(node->value);
+                return visit;
+            }
+
+            /**
+             * O(n) check that the links are in range and put every node at
+             * its rank, that keys increase, and that the red-black
+             * properties hold; worth running once on a file from elsewhere,
+             * since queries trust the links.
+             */
+            bool checkInvariants() const
+            {
+                struct Step
+                {
+                    uint32_t    index;
+                    int         blacks;
+                };
+                std::vector<Step> stack;
+                uint32_t          rank = 0;
+                int               blackHeight = -1;
+
+                if (_root == 0 ? _size != 0 : (_root > _size || _isRed(_root)))
+                    return false;
+                for (uint32_t i = _root, blacks = 0; i != 0 || !stack.empty(); )
+                {
+                    if (i != 0)
+                    {
+                        if (i > _size || stack.size() > 2 * 32)
+                            return false;
+                        blacks += !_isRed(i);
+                        Step step = {i, static_cast<int>(blacks)};
+                        stack.push_back(step);
+                        uint32_t left = _nodes[i - 1].left & ~_RED;
+                        if (left > _size || (left != 0 && _isRed(i) && _isRed(left)))
+                            return false;
+                        if (left == 0 && !_sameHeight(blackHeight, blacks))
+                            return false;
+                        i = left;
+                        continue;
+                    }
+                    Step step = stack.back();
+                    stack.pop_back();
+                    if (step.index != ++rank)
+                        return false;
+                    if (rank > 1 && !_compare(_nodes[rank - 2].value.first, _nodes[rank - 1].value.first))
+                        return false;
+                    i = _nodes[step.index - 1].right;
+                    blacks = static_cast<uint32_t>(step.blacks);
+                    if (i != 0 && (i > _size || (_isRed(step.index) && _isRed(i))))
+                        return false;
+                    if (i == 0 && !_sameHeight(blackHeight, blacks))
+                        return false;
+                }
+                return rank == _size;
+            }
+
+        private:
+            static const uint32_t _RED = 0x80000000u;
+            static const size_type _MAX_NODES = 0x7FFFFFFFu;
+            static const uint32_t _VERSION = 1;
+            static const uint32_t _BYTE_ORDER = 0x01020304u;
+            static const size_t _HEADER_SIZE = 64;
+
+            static_assert(sizeof(rb_image_header) <= _HEADER_SIZE, "rb_image_header outgrew its slot");
+
+            /* Closes the descriptor on every way out. */
+            struct _Fd
+            {
+                int fd;
+
+                explicit _Fd(int f):fd(f){}
+                ~_Fd(){if (fd >= 0) ::close(fd);}
+                _Fd(const _Fd&) = delete;
+                _Fd& operator=(const _Fd&) = delete;
+            };
+
+            /* path + ".tmp", removed again unless commit() synced it and renamed it over path. */
+            struct _TempFile
+            {
+                std::string target;
+                std::string path;
+                _Fd         fd;
+                bool        committed;
+
+                explicit _TempFile(const char* to)
+                    :target(to), path(target + ".tmp"), fd(::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)), committed(false)
+                {
+                    if (fd.fd < 0)
+                        _fail("cannot create", path.c_str());
+                }
+
+                ~_TempFile(){if (!committed) ::unlink(path.c_str());}
+
+                void commit()
+                {
+                    if (::fsync(fd.fd) != 0)
+                        _fail("cannot sync", path.c_str());
+                    if (::rename(path.c_str(), target.c_str()) != 0)
+                        _fail("cannot rename over", target.c_str());
+                    committed = true;
+                    /* Makes the rename itself durable; not every file system syncs directories. */
+                    std::string::size_type slash = target.rfind('/');
+                    std::string            directory = (slash == std::string::npos) ? "." : target.substr(0, slash + (slash == 0));
+                    _Fd                    dir(::open(directory.c_str(), O_RDONLY));
+                    if (dir.fd >= 0)
+                        ::fsync(dir.fd);
+                }
+            };
+
+            void*                                                                           _base;
+            size_t                                                                          _length;
+            const node_type*                                                                _nodes;
+            size_type                                                                       _size;
+            uint32_t                                                                        _root;
+            Compare                                                                         _compare;
+
+            static const char* _magic() {return "ftrbimg";}
+
+            static void _fail(const char* what, const char* path)
+            {
+                throw std::runtime_error(std::string("rb_image: ") + what + " " + path + ": " + std::strerror(errno));
+            }
+
+            static void _invalid(const char* path)
+            {
+                throw std::runtime_error(std::string("rb_image: ") + path + " is not an image of this value type");
+            }
+
+            void _release()
+            {
+                _length = 0;
+                _nodes = NULL;
+                _size = 0;
+                _root = 0;
+            }
+
+            void _unmap()
+            {
+                if (_base != NULL)
+                    ::munmap(_base, _length);
+                _base = NULL;
+                _release();
+            }
+
+            const node_type* _end() const {return _nodes + _size;}
+
+            bool _isRed(uint32_t i) const {return (_nodes[i - 1].left & _RED) != 0;}
+
+            static bool _sameHeight(int& blackHeight, uint32_t blacks)
+            {
+                if (blackHeight == -1)
+                    blackHeight = static_cast<int>(blacks);
+                return blackHeight == static_cast<int>(blacks);
+            }
+
+            const node_type* _lowerBound(const key_type& k) const
+            {
+                const node_type* result = _end();
+                for (uint32_t i = _root; i != 0; )
+                {
+                    const node_type& node = _nodes[i - 1];
+                    if (!_compare(node.value.first, k))
+                    {
+                        result = &node;
+                        i = node.left & ~_RED;
+                    }
+                    else
+                        i = node.right;
+                }
+                return result;
+            }
+
+            /* Stores the subtree in key order from nodes[next] on; returns its root's index + 1. */
+            template<class TreeNode>
+            static uint32_t _write(const TreeNode* node, node_type* nodes, uint32_t& next)
+            {
+                if (node == NULL)
+                    return 0;
+                uint32_t   left = _write(node->left, nodes, next);
+                uint32_t   index = next++;
+                node_type* out = nodes + index;
+                out->left = left | (node->getColor() == RED ? _RED : 0);
+                std::memcpy(static_cast<void*>(&out->value), static_cast<const void*>(&node->value), sizeof(value_type));
+                out->right = _write(node->right, nodes, next);
+                return index + 1;
+            }
+    };
+
+    /**
+     * An rb_image that turns into a mutable RBtree on the first write.
+     * Lookups and scans read the mapped file until then; tree(), insert
+     * or erase build the RBtree from the image in one O(n) pass with
+     * buildFromSorted and unmap the file. Requires C++11 and POSIX mmap.
+     */
+    template<class Pair, class Compare = std::less<typename std::remove_const<typename Pair::first_type>::type>,
+             class Allocator = std::allocator<Pair> >
+    class mapped_RBtree
+    {
+        public:
+            typedef Pair                                                                    value_type;
+            typedef typename std::remove_const<typename Pair::first_type>::type             key_type;
+            typedef size_t                                                                  size_type;
+            typedef ft::rb_image<Pair, Compare>                                             image_type;
+            typedef ft::RBtree<Pair, Compare, Allocator>                                    tree_type;
+
+            mapped_RBtree():_mapped(false){}
+            explicit mapped_RBtree(const char* path, const Compare& compare = Compare()):_image(path, compare), _mapped(true){}
+
+            /* True until the first write converts the image. */
+            bool isMapped() const {return _mapped;}
+
+            /* The mutable tree, built from the image the first time. */
+            tree_type& tree()
+            {
+                if (_mapped)
+                {
+                    _tree.buildFromSorted(_image.begin(), _image.end());
+                    _image = image_type();
+                    _mapped = false;
+                }
+                return _tree;
+            }
+
+            void RBTinsert(const value_type& val){tree().RBTinsert(val);}
+            int RBTdelete(const key_type& k){return tree().RBTdelete(k);}
+
+            /* The value held for k, or NULL. */
+            const value_type* search(const key_type& k) const
+            {
+                if (_mapped)
+                    return _image.search(k);
+                typename tree_type::node_type* node = _tree.search(k);
+                return node ? &node->value : NULL;
+            }
+
+            size_type size() const {return _mapped ? _image.size() : _tree.size();}
+            bool isEmpty() const {return size() == 0;}
+
+            template<class Visitor>
+            Visitor rangeScan(const key_type& lo, const key_type& hi, Visitor visit) const
+            {
+                return _mapped ? _image.rangeScan(lo, hi, visit) : _tree.rangeScan(lo, hi, visit);
+            }
+
+            /* Writes the current contents, from the image or the tree, to path. */
+            void save(const char* path) const
+            {
+                if (_mapped)
+                    _image.save(path);
+                else
+                    image_type::save(_tree, path);
+            }
+
+        private:
+            image_type                                                                      _image;
+            tree_type                                                                       _tree;
+            bool                                                                            _mapped;
+    };
+}
+
+#endif
@@ -0,0 +1,427 @@
+#ifndef PATH_COPY_TREE_HPP
+# define PATH_COPY_TREE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "red_black_tree.hpp"
+
+namespace ft{
+
+    /**
+     * Node of a path-copying red-black tree. There is no parent link, so
+     * one node can hang below several versions of the tree. A node is
+     * only written while its stamp is the stamp of the update that made it.
+     * refs counts the links to it when versions are reference counted.
+     */
+    template<class Pair>
+    class path_copy_node
+    {
+        public:
+            typedef Pair                            value_type;
+
+            path_copy_node                          *left;
+            path_copy_node                          *right;
+            size_t                                  stamp;
+            bool                                    color;
+            std::atomic<unsigned>                   refs;
+            value_type                              value;
+
+        path_copy_node(const value_type& val, bool c, path_copy_node* l, path_copy_node* r, size_t s)
+            :left(l), right(r), stamp(s), color(c), refs(1), value(val){}
+    };
+
+    /**
+     * Insert and erase for red-black trees whose published nodes never
+     * change. An update copies the root-to-leaf path it touches, plus the
+     * siblings the fix-ups recolour or rotate, and returns the new root;
+     * the old root still describes the old version in full.
+     *
+     * Each update is bracketed by _begin() and either the owner's commit
+     * or _rollback(). Meanwhile _created lists the nodes made by the
+     * update, _replaced the old nodes it copied and _disposed the new ones
+     * it dropped again. Nothing that already existed is written to, so
+     * when a copy throws, _rollback() frees the new nodes and the old
+     * version is intact. What happens to _replaced (freed later, or kept
+     * because another version shares it) is left to the owner.
+     * Stamps are unique across all trees of a type, so trees that share
+     * nodes never take each other's for their own. Requires C++11.
+     */
+    template<class Pair, class Compare, class Allocator>
+    class path_copy_tree
+    {
+        public:
+            typedef Pair                                                                    value_type;
+            typedef typename Pair::first_type                                               key_type;
+            typedef ft::path_copy_node<Pair>                                                node_type;
+            typedef typename Allocator::template rebind<node_type>::other                   node_allocator;
+            typedef size_t                                                                  size_type;
+
+        protected:
+            /* Red-black height is at most 2 log2(n + 1). */
+            static const int _MAX_DEPTH = 2 * std::numeric_limits<size_type>::digits + 2;
+
+            node_allocator                                                                  _myNodeAlloc;
+            Compare                                                                         _compare;
+            size_t                                                                          _stamp;
+            std::vector<node_type*>                                                         _created;
+            std::vector<node_type*>                                                         _replaced;
+            std::vector<node_type*>                                                         _disposed;
+
+            path_copy_tree(const Compare& compare, const Allocator& alloc)
+                :_myNodeAlloc(alloc), _compare(compare), _stamp(0){}
+
+            path_copy_tree(const Compare& compare, const node_allocator& alloc)
+                :_myNodeAlloc(alloc), _compare(compare), _stamp(0){}
+
+            template<class K>
+            node_type* _find(node_type* node, const K& k) const
+            {
+                while (node != NULL)
+                {
+                    if (_compare(k, node->value.first))
+                        node = node->left;
+                    else if (_compare(node->value.first, k))
+                        node = node->right;
+                    else
+                        return node;
+                }
+                return NULL;
+            }
+
+            /* Starts an update; the lists have room for any single update. */
+            void _begin()
+            {
+                static std::atomic<size_t> lastStamp(0);
+
+                _stamp = lastStamp.fetch_add(1, std::memory_order_relaxed) + 1;
+                _created.clear();
+                _replaced.clear();
+                _disposed.clear();
+                _created.reserve(4 * _MAX_DEPTH);
+                _replaced.reserve(4 * _MAX_DEPTH);
+                _disposed.reserve(2);
+            }
+
+            void _rollback()
+            {
+                for (size_type i = 0; i < _created.size(); ++i)
+                    _freeNode(_created[i]);
+                _created.clear();
+                _replaced.clear();
+                _disposed.clear();
+            }
+
+            bool _isNew(const node_type* node) const {return node->stamp == _stamp;}
+
+            void _freeNode(node_type* node)
+            {
+                _myNodeAlloc.destroy(node);
+                _myNodeAlloc.deallocate(node, 1);
+            }
+
+            /* Frees a tree no other version shares, with O(1) extra space. */
+            void _freeTree(node_type* node)
+            {
+                while (node != NULL)
+                {
+                    node_type* left = node->left;
+                    if (left != NULL)
+                    {
+                        node->left = left->right;
+                        left->right = node;
+                        node = left;
+                    }
+                    else
+                    {
+                        node_type* next = node->right;
+                        _freeNode(node);
+                        node = next;
+                    }
+                }
+            }
+
+            /* Returns the new root; root itself when k is already there. */
+            node_type* _insert(node_type* root, const value_type& val, bool& inserted)
+            {
+                node_type* path[_MAX_DEPTH + 1];
+                int        depth = 0;
+                bool       toLeft = false;
+
+                inserted = false;
+                for (node_type* node = root; node != NULL; )
+                {
+                    path[depth++] = node;
+                    toLeft = _compare(val.first, node->value.first);
+                    if (toLeft)
+                        node = node->left;
+                    else if (_compare(node->value.first, val.first))
+                        node = node->right;
+                    else
+                        return root;
+                }
+                node_type* node = _newNode(val, RED, NULL, NULL);
+                _copyPath(root, path, depth);
+                if (depth == 0)
+                    root = node;
+                else if (toLeft)
+                    path[depth - 1]->left = node;
+                else
+                    path[depth - 1]->right = node;
+                path[depth] = node;
+                _fixAfterInsert(root, path, depth);
+                root->color = BLACK;
+                inserted = true;
+                return root;
+            }
+
+            /* Returns the new root; root itself when k is not there. */
+            node_type* _erase(node_type* root, const key_type& k, bool& erased)
+            {
+                node_type* path[_MAX_DEPTH + 1];
+                int        depth = 0;
+                int        target = -1;
+
+                erased = false;
+                for (node_type* node = root; node != NULL; )
+                {
+                    path[depth++] = node;
+                    if (_compare(k, node->value.first))
+                        node = node->left;
+                    else if (_compare(node->value.first, k))
+                        node = node->right;
+                    else
+                    {
+                        target = depth - 1;
+                        break;
+                    }
+                }
+                if (target < 0)
+                    return root;
+
+                /* a node with two children trades places with its successor */
+                if (path[target]->left != NULL && path[target]->right != NULL)
+                    for (node_type* node = path[target]->right; node != NULL; node = node->left)
+                        path[depth++] = node;
+                node_type* successor = path[depth - 1];
+                if (successor != path[target])
+                {
+                    node_type* old = path[target];
+                    node_type* replacement = _newNode(successor->value, old->color, old->left, old->right);
+                    _copyPath(root, path, depth);
+                    node_type*& link = _link(root, path, target);
+                    replacement->left = path[target]->left;
+                    replacement->right = path[target]->right;
+                    _dispose(path[target]);
+                    link = replacement;
+                    path[target] = replacement;
+                }
+                else
+                    _copyPath(root, path, depth);
+
+                node_type*  removed = path[depth - 1];
+                node_type*  child = (removed->left != NULL) ? removed->left : removed->right;
+                bool        childIsLeft = (depth > 1 && path[depth - 2]->left == removed);
+
+                _link(root, path, depth - 1) = child;
+                _dispose(removed);
+                --depth;
+                if (removed->color == BLACK)
+                {
+                    if (child != NULL)
+                        _own(_link(root, path, depth, child))->color = BLACK;
+                    else
+                        _fixAfterErase(root, path, depth - 1, childIsLeft);
+                }
+                if (root != NULL)
+                    root->color = BLACK;
+                erased = true;
+                return root;
+            }
+
+        private:
+            node_type* _newNode(const value_type& val, bool color, node_type* left, node_type* right)
+            {
+                node_type *node = _myNodeAlloc.allocate(1);
+                try
+                {
+                    ::new (static_cast<void*>(node)) node_type(val, color, left, right, _stamp);
+                }
+                catch (...)
+                {
+                    _myNodeAlloc.deallocate(node, 1);
+                    throw;
+                }
+                _created.push_back(node);
+                return node;
+            }
+
+            /* Makes the node held by link writable, copying it if it is old. */
+            node_type* _own(node_type*& link)
+            {
+                node_type* node = link;
+                if (!_isNew(node))
+                {
+                    link = _newNode(node->value, node->color, node->left, node->right);
+                    _replaced.push_back(node);
+                }
+                return link;
+            }
+
+            void _dispose(node_type* node)
+            {
+                node->stamp = 0;
+                _disposed.push_back(node);
+            }
+
+            /* Replaces path[0..depth) with new copies, linked to each other. */
+            void _copyPath(node_type*& root, node_type** path, int depth)
+            {
+                for (int i = 0; i < depth; ++i)
+                    path[i] = _own(_link(root, path, i));
+            }
+
+            /* The link that holds path[i]: the root or a child field of path[i - 1]. */
+            static node_type*& _link(node_type*& root, node_type** path, int i)
+            {
+                return _link(root, path, i, path[i]);
+            }
+
+            /* Same for a node that is a child of path[i - 1] but not on the path. */
+            static node_type*& _link(node_type*& root, node_type** path, int i, node_type* node)
+            {
+                if (i == 0)
+                    return root;
+                return (path[i - 1]->left == node) ? path[i - 1]->left : path[i - 1]->right;
+            }
+
+            static void _rotateLeft(node_type*& link)
+            {
+                node_type* node = link;
+                node_type* right = node->right;
+
+                node->right = right->left;
+                right->left = node;
+                link = right;
+            }
+
+            static void _rotateRight(node_type*& link)
+            {
+                node_type* node = link;
+                node_type* left = node->left;
+
+                node->left = left->right;
+                left->right = node;
+                link = left;
+            }
+
+            static bool _isBlack(const node_type* node) {return node == NULL || node->color == BLACK;}
+
+            /* path[i] is the new red node; everything above it is already new. */
+            void _fixAfterInsert(node_type*& root, node_type** path, int i)
+            {
+                while (i >= 2 && path[i - 1]->color == RED)
+                {
+                    node_type* parent = path[i - 1];
+                    node_type* grand = path[i - 2];
+                    bool       parentIsLeft = (grand->left == parent);
+                    node_type* uncle = parentIsLeft ? grand->right : grand->left;
+
+                    if (!_isBlack(uncle))
+                    {
+                        _own(parentIsLeft ? grand->right : grand->left)->color = BLACK;
+                        parent->color = BLACK;
+                        grand->color = RED;
+                        i -= 2;
+                        continue;
+                    }
+                    node_type*& grandLink = _link(root, path, i - 2);
+                    if (parentIsLeft)
+                    {
+                        if (parent->right == path[i])
+                        {
+                            _rotateLeft(grand->left);
+                            parent = grand->left;
+                        }
+                        _rotateRight(grandLink);
+                    }
+                    else
+                    {
+                        if (parent->left == path[i])
+                        {
+                            _rotateRight(grand->right);
+                            parent = grand->right;
+                        }
+                        _rotateLeft(grandLink);
+                    }
+                    parent->color = BLACK;
+                    grand->color = RED;
+                    return;
+                }
+            }
+
+            /**
+             * A black leaf was cut below path[i], on the left if xIsLeft, so
+             * that side is one black short. Same cases as the pointer tree;
+             * the sibling and nephews are copied before they are changed.
+             */
+            void _fixAfterErase(node_type*& root, node_type** path, int i, bool xIsLeft)
+            {
+                node_type* x = NULL;
+
+                while (i >= 0 && _isBlack(x))
+                {
+                    node_type* parent = path[i];
+                    node_type* sibling = _own(xIsLeft ? parent->right : parent->left);
+
+                    if (sibling->color == RED)
+                    {
+                        sibling->color = BLACK;
+                        parent->color = RED;
+                        if (xIsLeft)
+                            _rotateLeft(_link(root, path, i));
+                        else
+                            _rotateRight(_link(root, path, i));
+                        path[i] = sibling;
+                        path[++i] = parent;
+                        sibling = _own(xIsLeft ? parent->right : parent->left);
+                    }
+                    node_type* nearNephew = xIsLeft ? sibling->left : sibling->right;
+                    node_type* farNephew = xIsLeft ? sibling->right : sibling->left;
+                    if (_isBlack(nearNephew) && _isBlack(farNephew))
+                    {
+                        sibling->color = RED;
+                        x = parent;
+                        if (--i >= 0)
+                            xIsLeft = (path[i]->left == x);
+                        continue;
+                    }
+                    if (_isBlack(farNephew))
+                    {
+                        _own(xIsLeft ? sibling->left : sibling->right)->color = BLACK;
+                        sibling->color = RED;
+                        if (xIsLeft)
+                            _rotateRight(parent->right);
+                        else
+                            _rotateLeft(parent->left);
+                        sibling = xIsLeft ? parent->right : parent->left;
+                    }
+                    sibling->color = parent->color;
+                    parent->color = BLACK;
+                    _own(xIsLeft ? sibling->right : sibling->left)->color = BLACK;
+                    if (xIsLeft)
+                        _rotateLeft(_link(root, path, i));
+                    else
+                        _rotateRight(_link(root, path, i));
+                    return;
+                }
+                if (x != NULL)
+                    x->color = BLACK;
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef PERSISTENT_RED_BLACK_TREE_HPP
+# define PERSISTENT_RED_BLACK_TREE_HPP
+
+#include <functional>
+#include <memory>
+
+#include "path_copy_tree.hpp"
+
+namespace ft{
+
+    /**
+     * Ordered map whose copies are snapshots: copying shares the whole
+     * tree in O(1), and insert/erase copy only the nodes on the path they
+     * touch (see path_copy_tree), so every copy keeps seeing the contents
+     * it was taken with. Nodes are reference counted by the links and
+     * trees pointing at them and go away with the last one.
+     *
+     * The counts are atomic, so copies may live in other threads, as long
+     * as each object is used by one thread at a time and the allocator can
+     * be shared between threads (std::allocator can). Requires C++11.
+     */
+    template<class Pair, class Compare = std::less<typename Pair::first_type>, class Allocator = std::allocator<Pair> >
+    class persistent_RBtree : private path_copy_tree<Pair, Compare, Allocator>
+    {
+        private:
+            typedef path_copy_tree<Pair, Compare, Allocator>                                _Base;
+
+        public:
+            typedef typename _Base::value_type                                              value_type;
+            typedef typename _Base::key_type                                                key_type;
+            typedef typename _Base::node_type                                               node_type;
+            typedef typename _Base::size_type                                               size_type;
+
+            explicit persistent_RBtree(const Compare& compare = Compare(), const Allocator& alloc = Allocator())
+                :_Base(compare, alloc), _root(NULL), _size(0){}
+
+            persistent_RBtree(const persistent_RBtree& x)
+                :_Base(x._compare, x._myNodeAlloc), _root(x._root), _size(x._size)
+            {
+                _share(_root);
+            }
+
+            persistent_RBtree& operator=(const persistent_RBtree& x)
+            {
+                if (this != &x)
+                {
+                    _share(x._root);
+                    _release(_root);
+                    _root = x._root;
+                    _size = x._size;
+                    this->_compare = x._compare;
+                    this->_myNodeAlloc = x._myNodeAlloc;
+                }
+                return (*this);
+            }
+
+            ~persistent_RBtree(){_release(_root);}
+
+            /* Same as a copy; spelled out for readability at call sites. */
+            persistent_RBtree snapshot() const {return *this;}
+
+            bool insert(const value_type& val)
+            {
+                node_type* root;
+                bool       inserted;
+
+                this->_begin();
+                try
+                {
+                    root = this->_insert(_root, val, inserted);
+                }
+                catch (...)
+                {
+                    this->_rollback();
+                    throw;
+                }
+                if (inserted)
+                {
+                    _commit(root);
+                    ++_size;
+                }
+                return inserted;
+            }
+
+            bool erase(const key_type& k)
+            {
+                node_type* root;
+                bool       erased;
+
+                this->_begin();
+                try
+                {
+                    root = this->_erase(_root, k, erased);
+                }
+                catch (...)
+                {
+                    this->_rollback();
+                    throw;
+                }
+                if (erased)
+                {
+                    _commit(root);
+                    --_size;
+                }
+                return erased;
+            }
+
+            void clear()
+            {
+                _release(_root);
+                _root = NULL;
+                _size = 0;
+            }
+
+            const value_type* search(const key_type& k) const
+            {
+                node_type* node = this->_find(_root, k);
+                return node ? &node->value : NULL;
+            }
+
+            size_type size() const {return _size;}
+            bool isEmpty() const {return _size == 0;}
+
+            /* Calls visitor on every value with lo <= key < hi, in key order. */
+            template<class Visitor>
+            Visitor rangeScan(const key_type& lo, const key_type& hi, Visitor visitor) const
+            {
+                const node_type* stack[_Base::_MAX_DEPTH + 1];
+                int              depth = 0;
+                const node_type* node = _root;
+
+                for (;;)
+                {
+                    while (node != NULL)
+                    {
+                        if (this->_compare(node->value.first, lo))
+                            node = node->right;
+                        else
+                        {
+                            stack[depth++] = node;
+                            node = node->left;
+                        }
+                    }
+                    if (depth == 0)
+                        return visitor;
+                    node = stack[--depth];
+                    if (!this->_compare(node->value.first, hi))
+                        return visitor;
+                    visitor(node->value);
+                    node = node->right;
+                }
+            }
+
+        private:
+            node_type*                                                                      _root;
+            size_type                                                                       _size;
+
+            static void _share(node_type* node)
+            {
+                if (node != NULL)
+                    node->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /* Drops one link to node, freeing what nobody links to any more. */
+            void _release(node_type* node)
+            {
+                node_type* stack[_Base::_MAX_DEPTH + 1];
+                int        depth = 0;
+
+                if (node != NULL && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    stack[depth++] = node;
+                while (depth > 0)
+                {
+                    node = stack[--depth];
+                    node_type* left = node->left;
+                    node_type* right = node->right;
+                    this->_freeNode(node);
+                    if (right != NULL && right->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        stack[depth++] = right;
+                    if (left != NULL && left->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        stack[depth++] = left;
+                }
+            }
+
+            /**
+             * The new nodes start with one link. Old nodes they point to
+             * gain one; then the old root lets go of its version, which
+             * frees the replaced path unless a snapshot still holds it.
+             */
+            void _commit(node_type* root)
+            {
+                for (size_type i = 0; i < this->_created.size(); ++i)
+                {
+                    node_type* node = this->_created[i];
+                    if (!this->_isNew(node))
+                        continue;
+                    if (node->left != NULL && !this->_isNew(node->left))
+                        _share(node->left);
+                    if (node->right != NULL && !this->_isNew(node->right))
+                        _share(node->right);
+                }
+                for (size_type i = 0; i < this->_disposed.size(); ++i)
+                    this->_freeNode(this->_disposed[i]);
+                _release(_root);
+                _root = root;
+            }
+    };
+}
+
+#endif
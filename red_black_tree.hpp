@@ -1,39 +1,357 @@
 #ifndef RED_BLACK_TREE_HPP
 # define RED_BLACK_TREE_HPP
 
+#include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 201103L
+# include <exception>
+# include <system_error>
+# include <thread>
+# include <tuple>
+# include <type_traits>
+#endif
 
 # define BLACK 0
 # define RED 1
 
+/* Number of descents RBtree::searchBatch interleaves. */
+# ifndef FT_RBTREE_BATCH_LANES
+#  define FT_RBTREE_BATCH_LANES 16
+# endif
+
+/* Subtrees smaller than this are never handed to another thread. */
+# ifndef FT_RBTREE_PARALLEL_CUTOFF
+#  define FT_RBTREE_PARALLEL_CUTOFF 8192
+# endif
+
+/**
+ * Defining FT_RBTREE_STATS gives every RBtree an rb_stats counter block,
+ * read through stats(). Without it the counting compiles away. Counts
+ * are relaxed atomic adds, since the parallel operations' threads and
+ * concurrent const lookups update the same block.
+ */
+# ifdef FT_RBTREE_STATS
+#  if defined(__GNUC__) || defined(__clang__)
+#   define FT_RBTREE_COUNT(counter, n) ((void)__atomic_fetch_add(&_stats.counter, size_t(n), __ATOMIC_RELAXED))
+#  else
+#   define FT_RBTREE_COUNT(counter, n) (_stats.counter += (n))
+#  endif
+# else
+#  define FT_RBTREE_COUNT(counter, n) ((void)0)
+# endif
+
+# if defined(__GNUC__) || defined(__clang__)
+#  define FT_RBTREE_PREFETCH(address) __builtin_prefetch(address)
+# else
+#  define FT_RBTREE_PREFETCH(address) ((void)0)
+# endif
+
 namespace ft{
 
-    template<class Pair>
-    class TNode
+#ifdef FT_RBTREE_STATS
+    /**
+     * Hot-path counters of an RBtree. Lookups are the descents of search,
+     * searchBatch, lower_bound and upper_bound. Recolourings count the
+     * colour writes of the fix-ups. The fix-up cases are named after what
+     * decides them: the uncle's colour on insert, and on erase the
+     * sibling's colour and then its children's.
+     */
+    struct rb_stats
+    {
+        size_t  lookups;
+        size_t  lookupComparisons;
+        size_t  rotations;
+        size_t  recolorings;
+        size_t  insertRedUncle;
+        size_t  insertBlackUncle;
+        size_t  eraseRedSibling;
+        size_t  eraseRedNephew;
+        size_t  eraseBlackNephews;
+        size_t  allocations;
+        size_t  deallocations;
+
+        rb_stats():lookups(0), lookupComparisons(0), rotations(0), recolorings(0), insertRedUncle(0),
+            insertBlackUncle(0), eraseRedSibling(0), eraseRedNephew(0), eraseBlackNephews(0),
+            allocations(0), deallocations(0){}
+    };
+#endif
+
+    /**
+     * Shape of an RBtree, from RBtree::shape(). depths[d] is the number of
+     * nodes at depth d, the root being at 0; height is depths.size().
+     * blackHeight counts the black nodes from the root down to a leaf.
+     * violation names the first broken invariant found, or is NULL.
+     */
+    struct rb_shape
+    {
+        size_t              size;
+        size_t              height;
+        size_t              blackHeight;
+        std::vector<size_t> depths;
+        const char          *violation;
+
+        rb_shape():size(0), height(0), blackHeight(0), violation(NULL){}
+    };
+
+    /**
+     * Augmentation policies. A policy gives every node a node_data base
+     * and recomputes it from the node and its children in update(); the
+     * tree calls update() wherever a subtree changes. enabled lets the
+     * tree skip the bookkeeping walks entirely for rb_no_augment.
+     * Policies with an aggregate_type also support RBtree::reduce through
+     * identity(), combine(), lift() (one node) and aggregate() (a subtree).
+     */
+    struct rb_no_augment
+    {
+        enum { enabled = 0 };
+
+        typedef void                                aggregate_type;
+
+        struct node_data {};
+
+        template<class Node>
+        static void update(Node*) {}
+    };
+
+    /* Keeps subtree sizes, which RBtree::select and RBtree::rank need. */
+    struct rb_order_statistic
+    {
+        enum { enabled = 1 };
+
+        /* reduce() counts the keys in a range */
+        typedef size_t                              aggregate_type;
+
+        struct node_data
+        {
+            size_t                                  subtreeSize;
+        };
+
+        template<class Node>
+        static size_t count(const Node* node) {return node ? node->subtreeSize : 0;}
+
+        template<class Node>
+        static void update(Node* node) {node->subtreeSize = 1 + count(node->left) + count(node->right);}
+
+        static size_t identity() {return 0;}
+        static size_t combine(size_t a, size_t b) {return a + b;}
+
+        template<class Node>
+        static size_t lift(const Node*) {return 1;}
+
+        template<class Node>
+        static size_t aggregate(const Node* node) {return count(node);}
+    };
+
+    /**
+     * Caches, per subtree, Monoid::combine over the mapped values in key
+     * order, next to the subtree size. Monoid provides value_type,
+     * identity() and an associative combine(a, b); mapped values must
+     * convert to value_type.
+     */
+    template<class Monoid>
+    struct rb_aggregate
+    {
+        enum { enabled = 1 };
+
+        typedef typename Monoid::value_type         aggregate_type;
+
+        struct node_data
+        {
+            size_t                                  subtreeSize;
+            aggregate_type                          aggregateValue;
+        };
+
+        template<class Node>
+        static size_t count(const Node* node) {return node ? node->subtreeSize : 0;}
+
+        template<class Node>
+        static void update(Node* node)
+        {
+            node->subtreeSize = 1 + count(node->left) + count(node->right);
+            node->aggregateValue = combine(combine(aggregate(node->left), lift(node)), aggregate(node->right));
+        }
+
+        static aggregate_type identity() {return Monoid::identity();}
+        static aggregate_type combine(const aggregate_type& a, const aggregate_type& b) {return Monoid::combine(a, b);}
+
+        template<class Node>
+        static aggregate_type lift(const Node* node) {return aggregate_type(node->value.second);}
+
+        template<class Node>
+        static aggregate_type aggregate(const Node* node) {return node ? node->aggregateValue : Monoid::identity();}
+    };
+
+    template<bool B>
+    struct _rb_bool {};
+
+    /**
+     * value is true when Augment has a count(const Node*) giving subtree
+     * sizes, as rb_order_statistic and rb_aggregate do.
+     */
+    template<class Augment, class Node>
+    class _rb_counts_subtrees
     {
+        private:
+            typedef char                                _Yes;
+            typedef char                                _No[2];
+
+            template<size_t (*)(const Node*)>
+            struct _Signature {};
+
+            template<class A>
+            static _Yes& _test(_Signature<&A::template count<Node> >*);
+            template<class A>
+            static _No& _test(...);
+
         public:
-            typedef Pair                            value_type;
+            enum { value = (sizeof(_test<Augment>(0)) == sizeof(_Yes)) };
+    };
 
-            value_type                              *data; 
-            TNode                                   *left;
-            TNode                                   *right;
-            TNode                                   *parent;
+    template<class T>
+    struct rb_sum
+    {
+        typedef T                                   value_type;
+        static T identity() {return T();}
+        static T combine(const T& a, const T& b) {return a + b;}
+    };
+
+    template<class T>
+    struct rb_min
+    {
+        typedef T                                   value_type;
+        static T identity() {return std::numeric_limits<T>::max();}
+        static T combine(const T& a, const T& b) {return (b < a) ? b : a;}
+    };
+
+    template<class T>
+    struct rb_max
+    {
+        typedef T                                   value_type;
+        static T identity() {return std::numeric_limits<T>::is_integer ? std::numeric_limits<T>::min() : -std::numeric_limits<T>::max();}
+        static T combine(const T& a, const T& b) {return (a < b) ? b : a;}
+    };
+
+    /**
+     * Node layouts, the last template argument of RBtree. A layout gives
+     * every node a links base holding left, right and parent, with the
+     * colour read through getColor() and written through setColor().
+     *
+     * rb_pointer_node is the classic layout: a bool colour, plus data, a
+     * pointer to the node's own value kept for existing callers.
+     */
+    struct rb_pointer_node
+    {
+        template<class Node, class Value>
+        struct links
+        {
+            Node                                    *left;
+            Node                                    *right;
+            Node                                    *parent;
+            Value                                   *data;
             bool                                    color;
+
+            explicit links(Value* value):left(NULL), right(NULL), parent(NULL), data(value), color(RED){}
+            links(const links& x, Value* value):left(x.left), right(x.right), parent(x.parent), data(value), color(x.color){}
+
+            bool getColor() const {return color;}
+            void setColor(bool c) {color = c;}
+        };
+    };
+
+    /**
+     * Parent link of rb_compact_node: reads and assigns like a Node*, and
+     * keeps the node's colour in bit 0, which node alignment leaves free.
+     * Assigning another link copies the pointer, never the colour.
+     */
+    template<class Node>
+    class rb_tagged_parent
+    {
+        public:
+            rb_tagged_parent(Node* node, bool color):_bits(reinterpret_cast<size_t>(node) | size_t(color)){}
+
+            operator Node*() const {return reinterpret_cast<Node*>(_bits & ~size_t(1));}
+            Node* operator->() const {return *this;}
+
+            rb_tagged_parent& operator=(Node* node)
+            {
+                _bits = reinterpret_cast<size_t>(node) | (_bits & 1);
+                return (*this);
+            }
+
+            rb_tagged_parent& operator=(const rb_tagged_parent& x) {return (*this = static_cast<Node*>(x));}
+
+            bool color() const {return (_bits & 1) != 0;}
+            void setColor(bool c) {_bits = (_bits & ~size_t(1)) | size_t(c);}
+
+        private:
+            size_t                                  _bits;
+    };
+
+    /**
+     * Three words of links and nothing else: no data pointer, and the
+     * colour packed into parent. A pair of longs takes 40 bytes instead
+     * of 56. Callers use value instead of *data.
+     */
+    struct rb_compact_node
+    {
+        template<class Node, class Value>
+        struct links
+        {
+            Node                                    *left;
+            Node                                    *right;
+            rb_tagged_parent<Node>                  parent;
+
+            explicit links(Value*):left(NULL), right(NULL), parent(NULL, RED){}
+            links(const links& x, Value*):left(x.left), right(x.right), parent(x.parent){}
+
+            bool getColor() const {return parent.color();}
+            void setColor(bool c) {parent.setColor(c);}
+        };
+    };
+
+    /**
+     * The value is stored inline, right after the links, so a node is a
+     * single allocation and the key shares its cache line with left/right.
+     */
+    template<class Pair, class Augment = rb_no_augment, class Layout = rb_pointer_node>
+    class TNode : public Augment::node_data, public Layout::template links<TNode<Pair, Augment, Layout>, Pair>
+    {
+        private:
+            typedef typename Layout::template links<TNode, Pair>    _Links;
+
+        public:
+            typedef Pair                            value_type;
+
+            value_type                              value;
         
 
-        TNode():data(NULL), left(NULL), right(NULL), parent(NULL), color(RED){}
+        TNode():_Links(&value), value(){Augment::update(this);}
         
-        TNode(const TNode<Pair>& obj){*this = obj;}
-        TNode(const value_type& data):data(data), left(NULL), right(NULL), parent(NULL), color(RED){}
+        TNode(const TNode& obj):Augment::node_data(obj), _Links(obj, &value), value(obj.value){}
+        TNode(const value_type& val):_Links(&value), value(val){Augment::update(this);}
+
+#if __cplusplus >= 201103L
+        struct emplace_tag {};
+
+        template<class... Args>
+        TNode(emplace_tag, Args&&... args):_Links(&value), value(std::forward<Args>(args)...){Augment::update(this);}
+#endif
         
-        TNode<Pair>& operator=(const TNode<Pair>& obj)
+        TNode& operator=(const TNode& obj)
         {
-            this->data = obj->data;
-            this->left = obj->left;
-            this->right = obj->right;
-            this->parent = obj->parent;
-            this->color = obj.color;
+            this->left = obj.left;
+            this->right = obj.right;
+            this->parent = obj.parent;
+            this->setColor(obj.getColor());
+            return (*this);
         }
 
         ~TNode(){}
@@ -41,8 +359,8 @@ namespace ft{
 
         TNode*      getGrandFather()
         {
-            if (parent) 
-                return parent->parent;
+            if (this->parent) 
+                return this->parent->parent;
             return NULL;
         }
 
@@ -50,7 +368,7 @@ namespace ft{
         {
             if (getGrandFather() != NULL)
             {
-                if (parent->isLeftChild())
+                if (this->parent->isLeftChild())
                     return getGrandFather()->right;
                 else
                     return getGrandFather()->left;
@@ -60,7 +378,7 @@ namespace ft{
 
         TNode*      getSibling()
         {
-            if (parent != NULL)
+            if (this->parent != NULL)
             {
                 if (this->isLeftChild())
                     return this->parent->right;
@@ -70,13 +388,306 @@ namespace ft{
             return NULL;
         }
 
-        void        flipColor() { (color!= BLACK) ? color = BLACK : color = RED;}
+        void        flipColor() {this->setColor(this->getColor() == BLACK ? RED : BLACK);}
 
-        bool        isLeftChild(){return this == parent->left;};
-        bool        isRightChild(){return this == parent->right;};
+        bool        isLeftChild(){return this == this->parent->left;};
+        bool        isRightChild(){return this == this->parent->right;};
   
 };
 
+    template<class Alloc>
+    class _node_pool_access;
+
+    /**
+     * Allocator that carves single objects out of fixed-size slabs and keeps
+     * freed ones on a free list, so insert/erase churn never reaches malloc.
+     * Copies share the same pool; a rebound copy gets a pool of its own.
+     * Requests for more than one object go straight to operator new.
+     */
+    template<class T, size_t ObjectsPerSlab = 256>
+    class node_pool_allocator
+    {
+        public:
+            typedef T                                       value_type;
+            typedef T*                                      pointer;
+            typedef const T*                                const_pointer;
+            typedef T&                                      reference;
+            typedef const T&                                const_reference;
+            typedef size_t                                  size_type;
+            typedef ptrdiff_t                               difference_type;
+
+            template<class U>
+            struct rebind { typedef node_pool_allocator<U, ObjectsPerSlab> other; };
+
+        private:
+            template<class> friend class _node_pool_access;
+
+            struct _AlignProbe { char c; T object; };
+            struct _FreeObject { _FreeObject *next; };
+            struct _Slab { _Slab *next; };
+            struct _Pool
+            {
+                _FreeObject     *freeList;
+                _Slab           *slabs;
+                char            *cursor;
+                char            *end;
+                size_type       slabCount;
+                size_type       refs;
+                size_type       detached;
+            };
+
+            enum
+            {
+                _ALIGN = (sizeof(_AlignProbe) - sizeof(T)) > sizeof(void*) ? (sizeof(_AlignProbe) - sizeof(T)) : sizeof(void*),
+                _OBJECT_SIZE = ((sizeof(T) > sizeof(_FreeObject) ? sizeof(T) : sizeof(_FreeObject)) + _ALIGN - 1) / _ALIGN * _ALIGN,
+                _HEADER_SIZE = (sizeof(_Slab) + _ALIGN - 1) / _ALIGN * _ALIGN
+            };
+
+            _Pool                                           *_pool;
+
+        public:
+            node_pool_allocator():_pool(_newPool()){}
+            node_pool_allocator(const node_pool_allocator& x):_pool(x._pool){++_pool->refs;}
+            template<class U>
+            node_pool_allocator(const node_pool_allocator<U, ObjectsPerSlab>&):_pool(_newPool()){}
+
+            node_pool_allocator& operator=(const node_pool_allocator& x)
+            {
+                ++x._pool->refs;
+                _unref();
+                _pool = x._pool;
+                return (*this);
+            }
+
+            ~node_pool_allocator(){_unref();}
+
+            pointer         address(reference x) const {return &x;}
+            const_pointer   address(const_reference x) const {return &x;}
+            size_type       max_size() const {return size_type(-1) / sizeof(T);}
+
+            pointer allocate(size_type n, const void* = 0)
+            {
+                if (n != 1)
+                    return static_cast<pointer>(::operator new(n * sizeof(T)));
+                if (_pool->freeList != NULL)
+                {
+                    _FreeObject *object = _pool->freeList;
+                    _pool->freeList = object->next;
+                    return reinterpret_cast<pointer>(object);
+                }
+                if (_pool->cursor == _pool->end)
+                    _addSlab();
+                pointer object = reinterpret_cast<pointer>(_pool->cursor);
+                _pool->cursor += _OBJECT_SIZE;
+                return object;
+            }
+
+            void deallocate(pointer p, size_type n)
+            {
+                if (n != 1)
+                {
+                    ::operator delete(p);
+                    return;
+                }
+                _FreeObject *object = reinterpret_cast<_FreeObject*>(p);
+                object->next = _pool->freeList;
+                _pool->freeList = object;
+            }
+
+            void construct(pointer p, const_reference val) {::new (static_cast<void*>(p)) T(val);}
+            void destroy(pointer p) {p->~T();}
+
+            /* Number of slabs currently held, mostly useful for benchmarks. */
+            size_type slab_count() const {return _pool->slabCount;}
+
+            /* True when no other allocator shares this pool. */
+            bool unique() const {return _pool->refs == 1;}
+
+            /**
+             * Gives every slab back to the system in O(slabs). All memory
+             * handed out by this pool becomes invalid.
+             */
+            void release()
+            {
+                while (_pool->slabs != NULL)
+                {
+                    _Slab *next = _pool->slabs->next;
+                    ::operator delete(_pool->slabs);
+                    _pool->slabs = next;
+                }
+                _pool->freeList = NULL;
+                _pool->cursor = NULL;
+                _pool->end = NULL;
+                _pool->slabCount = 0;
+            }
+
+            bool operator==(const node_pool_allocator& x) const {return _pool == x._pool;}
+            bool operator!=(const node_pool_allocator& x) const {return _pool != x._pool;}
+
+        private:
+            static _Pool* _newPool()
+            {
+                _Pool *pool = new _Pool;
+                pool->freeList = NULL;
+                pool->slabs = NULL;
+                pool->cursor = NULL;
+                pool->end = NULL;
+                pool->slabCount = 0;
+                pool->refs = 1;
+                pool->detached = 0;
+                return pool;
+            }
+
+            void _unref()
+            {
+                if (--_pool->refs == 0)
+                {
+                    release();
+                    delete _pool;
+                }
+            }
+
+            void _addSlab()
+            {
+                char *memory = static_cast<char*>(::operator new(_HEADER_SIZE + _OBJECT_SIZE * ObjectsPerSlab));
+                _Slab *slab = reinterpret_cast<_Slab*>(memory);
+                slab->next = _pool->slabs;
+                _pool->slabs = slab;
+                _pool->cursor = memory + _HEADER_SIZE;
+                _pool->end = _pool->cursor + _OBJECT_SIZE * ObjectsPerSlab;
+                ++_pool->slabCount;
+            }
+    };
+
+    /**
+     * Lets RBtree::clear() drop a whole arena at once when its node
+     * allocator is a node_pool_allocator nobody else shares. The pool also
+     * counts the node handles RBtree gave out, which the arena must not
+     * take with it.
+     */
+    template<class Alloc>
+    class _node_pool_access
+    {
+        public:
+            static bool releasable(const Alloc&) {return false;}
+            static void release(Alloc&) {}
+            static void detach(Alloc&) {}
+            static void attach(Alloc&) {}
+    };
+
+    template<class T, size_t N>
+    class _node_pool_access<node_pool_allocator<T, N> >
+    {
+        public:
+            static bool releasable(const node_pool_allocator<T, N>& alloc) {return alloc.unique() && alloc._pool->detached == 0;}
+            static void release(node_pool_allocator<T, N>& alloc) {alloc.release();}
+            static void detach(node_pool_allocator<T, N>& alloc) {++alloc._pool->detached;}
+            static void attach(node_pool_allocator<T, N>& alloc)
+            {
+                if (alloc._pool->detached != 0)
+                    --alloc._pool->detached;
+            }
+    };
+
+    /**
+     * Whether copies of Alloc may allocate and free from several threads
+     * at once, which the parallel operations of RBtree need; they run
+     * serially otherwise. Specialize it for other thread-safe allocators.
+     */
+    template<class Alloc>
+    struct rb_concurrent_allocator
+    {
+        static const bool value = false;
+    };
+
+    template<class T>
+    struct rb_concurrent_allocator<std::allocator<T> >
+    {
+        static const bool value = true;
+    };
+
+    /**
+     * Bidirectional iterator over the nodes of an RBtree, in key order.
+     * Steps follow the parent links, so an increment is O(1) amortized.
+     * end() is the tree's min/max sentinel, whose left/right are the
+     * min and the max, so --end() lands on the max.
+     */
+    /* Enables the iterator -> const_iterator conversion and not the reverse. */
+    template<class From, class To>
+    struct _rb_adds_const {};
+
+    template<class T>
+    struct _rb_adds_const<T, const T> { typedef int type; };
+
+    template<class Node, class T>
+    class RBTiterator
+    {
+        public:
+            typedef std::bidirectional_iterator_tag         iterator_category;
+            typedef T                                       value_type;
+            typedef ptrdiff_t                               difference_type;
+            typedef T*                                      pointer;
+            typedef T&                                      reference;
+
+            RBTiterator():_node(NULL), _sentinel(NULL){}
+            RBTiterator(Node* node, Node* sentinel):_node(node), _sentinel(sentinel){}
+            template<class U>
+            RBTiterator(const RBTiterator<Node, U>& x, typename _rb_adds_const<U, T>::type = 0):_node(x.node()), _sentinel(x.sentinel()){}
+
+            reference   operator*() const {return _node->value;}
+            pointer     operator->() const {return &_node->value;}
+
+            RBTiterator& operator++()
+            {
+                if (_node->right != NULL)
+                {
+                    _node = _node->right;
+                    while (_node->left != NULL)
+                        _node = _node->left;
+                    return (*this);
+                }
+                while (_node->parent != NULL && _node == _node->parent->right)
+                    _node = _node->parent;
+                _node = (_node->parent != NULL) ? _node->parent : _sentinel;
+                return (*this);
+            }
+
+            RBTiterator& operator--()
+            {
+                if (_node == _sentinel)
+                {
+                    _node = _sentinel->right;
+                    return (*this);
+                }
+                if (_node->left != NULL)
+                {
+                    _node = _node->left;
+                    while (_node->right != NULL)
+                        _node = _node->right;
+                    return (*this);
+                }
+                while (_node->parent != NULL && _node == _node->parent->left)
+                    _node = _node->parent;
+                _node = _node->parent;
+                return (*this);
+            }
+
+            RBTiterator operator++(int) {RBTiterator tmp(*this); ++(*this); return tmp;}
+            RBTiterator operator--(int) {RBTiterator tmp(*this); --(*this); return tmp;}
+
+            template<class U>
+            bool operator==(const RBTiterator<Node, U>& x) const {return _node == x.node();}
+            template<class U>
+            bool operator!=(const RBTiterator<Node, U>& x) const {return _node != x.node();}
+
+            Node*       node() const {return _node;}
+            Node*       sentinel() const {return _sentinel;}
+
+        private:
+            Node                                            *_node;
+            Node                                            *_sentinel;
+    };
+
 /**
  * In red black tree we use recoloring and rotation
  * if recoloring doesn't work, then we go for rotation
@@ -88,7 +699,7 @@ namespace ft{
  */
 
 
-    template<class Pair, class Compare, class Allocator >
+    template<class Pair, class Compare, class Allocator, class Augment = rb_no_augment, class Layout = rb_pointer_node>
     class RBtree
     {
 
@@ -97,278 +708,1984 @@ namespace ft{
             typedef Pair                                                                    value_type;
             typedef typename Pair::first_type                                               key_type;
             typedef Allocator                                                               type_allocator;
-            typedef typename Allocator::template rebind<ft::TNode<Pair> >::other	        node_allocator;
+            typedef ft::TNode<Pair, Augment, Layout>                                        node_type;
+            typedef typename Allocator::template rebind<node_type>::other	                node_allocator;
             typedef size_t                                                                  size_type;
+            typedef ft::RBTiterator<node_type, value_type>                                  iterator;
+            typedef ft::RBTiterator<node_type, const value_type>                            const_iterator;
 
 
         private:
-            ft::TNode<value_type>*                                                          _tree;
+            /**
+             * The min/max sentinel lives inside the tree object, so building,
+             * moving and clearing a tree never allocate for it. Only its
+             * links are ever used; the value part stays unconstructed.
+             * C++98 has no alignas, so there the union only covers the
+             * alignment of the fundamental types.
+             */
+#if __cplusplus >= 201103L
+            struct _SentinelStorage
+            {
+                alignas(node_type) char                                                     bytes[sizeof(node_type)];
+            };
+#else
+            union _SentinelStorage
+            {
+                char                                                                        bytes[sizeof(node_type)];
+                void                                                                        *alignPtr;
+                long                                                                        alignLong;
+                long double                                                                 alignDouble;
+            };
+#endif
+
+            node_type*                                                                      _tree;
             type_allocator                                                                  _myPairAlloc;
             node_allocator                                                                  _myNodeAlloc;
             size_type                                                                       _size;
             Compare                                                                         _compare;
-            ft::TNode<value_type>*                                                          _minMax;
+            _SentinelStorage                                                                _minMaxStorage;
+            node_type*                                                                      _minMax;
+#ifdef FT_RBTREE_STATS
+            mutable rb_stats                                                                _stats;
+#endif
 
         public:
             RBtree():_tree(NULL), _myPairAlloc(), _myNodeAlloc(), _size(0)
             {
-                _minMax = _myNodeAlloc.allocate(1);
-                _minMax->left = NULL;
-                _minMax->right = NULL;
+                _initSentinel();
+            }
+
+            RBtree(const RBtree& x):_tree(NULL),_myPairAlloc(x._myPairAlloc), _myNodeAlloc(x._myNodeAlloc), _size(0), _compare(x._compare)
+            {
+                _initSentinel();
+                _copyFrom(x);
+            }
+
+            RBtree& operator=(const RBtree& x)
+            {
+                if (this == &x)
+                    return (*this);
+                clear();
+                _myPairAlloc = x._myPairAlloc;
+                _myNodeAlloc = x._myNodeAlloc;
+                _compare = x._compare;
+                _copyFrom(x);
+                return (*this);
+            }
+
+#if __cplusplus >= 201103L
+            RBtree(RBtree&& x) noexcept
+                :_tree(x._tree), _myPairAlloc(x._myPairAlloc), _myNodeAlloc(x._myNodeAlloc), _size(x._size), _compare(x._compare)
+            {
+                _initSentinel();
+                _minMax->left = x._minMax->left;
+                _minMax->right = x._minMax->right;
+                x._tree = NULL;
+                x._size = 0;
+                x._minMax->left = NULL;
+                x._minMax->right = NULL;
+            }
+
+            /* Our old nodes are freed; x is left empty with our allocators. */
+            RBtree& operator=(RBtree&& x) noexcept
+            {
+                if (this != &x)
+                {
+                    clear();
+                    swap(x);
+                }
+                return (*this);
+            }
+#endif
+
+            void clear(){
+                if (_tree != NULL)
+                {
+                    if (_node_pool_access<node_allocator>::releasable(_myNodeAlloc))
+                    {
+                        /* drop the whole arena instead of freeing node by node */
+#if __cplusplus >= 201103L
+                        if (!std::is_trivially_destructible<value_type>::value)
+#endif
+                            _destroyValues(_tree);
+                        _node_pool_access<node_allocator>::release(_myNodeAlloc);
+                        FT_RBTREE_COUNT(deallocations, _size);
+                        _tree = NULL;
+                    }
+                    else
+                        delete_all(_tree);
+                }
+                _minMax->left = NULL;
+                _minMax->right = NULL;
+                _size = 0;
+                _tree = NULL;
+            }
+
+            ~RBtree(){this->clear();}
+
+            /* Frees a node, typically a handle from extract or split. */
+            void deleteNode(node_type * &node)
+            {
+                _node_pool_access<node_allocator>::attach(_myNodeAlloc);
+                _freeNode(node);
+            }
+
+            void delete_all(node_type* &node)
+            {
+                _teardown(node, true);
+                node = NULL;
+                _minMax->left = NULL;
+                _minMax->right = NULL;
+                _size = 0;
+            }
+
+            void swap(RBtree &x)
+            {
+                node_type*tmp = _tree;
+                _tree = x._tree;
+                x._tree = tmp;
+                
+                size_t sizetmp = _size;
+                _size = x._size;
+                x._size = sizetmp;
+                std::swap(_minMax->left, x._minMax->left);
+                std::swap(_minMax->right, x._minMax->right);
+                std::swap(_compare, x._compare);
+
+                /* nodes have to be freed by the allocator that made them */
+                std::swap(_myPairAlloc, x._myPairAlloc);
+                std::swap(_myNodeAlloc, x._myNodeAlloc);
+
+            }
+    
+            void RBTinsert(const value_type& val){insert(val);}
+
+            /**
+             * Finds the slot and detects a duplicate in the same descent.
+             * Returns the node holding the key and whether it was inserted.
+             */
+            std::pair<node_type*, bool> insert(const value_type& val)
+            {
+                node_type* parent;
+                bool               toLeft;
+                node_type* found = _findInsertPos(val.first, parent, toLeft);
+
+                if (found)
+                    return std::make_pair(found, false);
+                node_type* new_element = _createNode(val);
+                _insertAt(new_element, parent, toLeft);
+                return std::make_pair(new_element, true);
+            }
+
+            /**
+             * Inserts next to hint when the key belongs right before or after
+             * it, in O(1) amortized; otherwise falls back to a full descent.
+             * Returns the element holding the key, as std::map does.
+             */
+            iterator insert(const_iterator hint, const value_type& val)
+            {
+                node_type* parent;
+                bool               toLeft;
+                node_type* found = _findHintPos(hint.node(), val.first, parent, toLeft);
+
+                if (found)
+                    return iterator(found, _minMax);
+                node_type* new_element = _createNode(val);
+                _insertAt(new_element, parent, toLeft);
+                return iterator(new_element, _minMax);
+            }
+
+#if __cplusplus >= 201103L
+            template<class... Args>
+            std::pair<node_type*, bool> emplace(Args&&... args)
+            {
+                node_type* new_element = _createNode(std::forward<Args>(args)...);
+                node_type* parent;
+                bool               toLeft;
+                node_type* found = _findInsertPos(new_element->value.first, parent, toLeft);
+
+                if (found)
+                {
+                    _freeNode(new_element);
+                    return std::make_pair(found, false);
+                }
+                _insertAt(new_element, parent, toLeft);
+                return std::make_pair(new_element, true);
+            }
+
+            /* Builds the value only when k is not in the tree yet. */
+            template<class K, class... Args>
+            std::pair<node_type*, bool> try_emplace(K&& k, Args&&... args)
+            {
+                node_type* parent;
+                bool               toLeft;
+                node_type* found = _findInsertPos(k, parent, toLeft);
+
+                if (found)
+                    return std::make_pair(found, false);
+                node_type* new_element = _createNode(std::piecewise_construct,
+                    std::forward_as_tuple(std::forward<K>(k)),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+                _insertAt(new_element, parent, toLeft);
+                return std::make_pair(new_element, true);
+            }
+#endif
+
+            /**
+             * Replaces the contents with [first, last), which must be sorted
+             * by key. Builds a balanced tree in O(n): nodes are created in
+             * order and linked straight into place, the bottom level is red
+             * and everything above it black, so no rotation is needed.
+             * Of several equivalent keys only the first is kept.
+             */
+            template<class ForwardIt>
+            void buildFromSorted(ForwardIt first, ForwardIt last)
+            {
+                clear();
+                size_type n = 0;
+                for (ForwardIt it = first; it != last; _skipEquivalent(it, last))
+                    ++n;
+                if (n == 0)
+                    return;
+                int redDepth = 0;
+                for (size_type m = n; m > 1; m >>= 1)
+                    ++redDepth;
+                _tree = _buildSorted(first, last, n, 0, redDepth);
+                _tree->setColor(BLACK);
+                _size = n;
+                _minMax->left = getMin(_tree);
+                _minMax->right = getMax(_tree);
+            }
+
+            /* Same as buildFromSorted for unsorted input, sorted by key first. */
+            template<class InputIt>
+            void buildFromRange(InputIt first, InputIt last)
+            {
+                std::vector<value_type>        values(first, last);
+                std::vector<const value_type*> sorted;
+
+                sorted.reserve(values.size());
+                for (size_type i = 0; i < values.size(); ++i)
+                    sorted.push_back(&values[i]);
+                std::stable_sort(sorted.begin(), sorted.end(), _ValuePtrCompare(_compare));
+                buildFromSorted(_PtrIterator<typename std::vector<const value_type*>::const_iterator>(sorted.begin()),
+                    _PtrIterator<typename std::vector<const value_type*>::const_iterator>(sorted.end()));
+            }
+
+            /**
+             * Replaces the contents with the merge of several runs, each
+             * [first, last) sorted by key, in one pass over the input: a heap
+             * picks the smallest run head, each value is copied once into a
+             * node appended to a list, and the list is linked into the same
+             * balanced tree as buildFromSorted builds. Runs only need input
+             * iterators. Of equivalent keys the first of the earliest run
+             * is kept.
+             */
+            template<class InputIt>
+            void buildFromSortedRuns(const std::vector<std::pair<InputIt, InputIt> >& runs)
+            {
+                std::vector<std::pair<InputIt, InputIt> > heads(runs);
+                std::vector<size_type>                    heap;
+                _RunCompare<InputIt>                      later(heads, _compare);
+                node_type*                                first = NULL;
+                node_type*                                last = NULL;
+                size_type                                 n = 0;
+
+                clear();
+                for (size_type i = 0; i < heads.size(); ++i)
+                    if (heads[i].first != heads[i].second)
+                        heap.push_back(i);
+                std::make_heap(heap.begin(), heap.end(), later);
+                try
+                {
+                    while (!heap.empty())
+                    {
+                        std::pop_heap(heap.begin(), heap.end(), later);
+                        InputIt& it = heads[heap.back()].first;
+                        if (last == NULL || _compare(last->value.first, (*it).first))
+                        {
+                            node_type* node = _createNode(*it);
+                            if (last == NULL)
+                                first = node;
+                            else
+                                last->right = node;
+                            last = node;
+                            ++n;
+                        }
+                        ++it;
+                        if (it != heads[heap.back()].second)
+                            std::push_heap(heap.begin(), heap.end(), later);
+                        else
+                            heap.pop_back();
+                    }
+                }
+                catch (...)
+                {
+                    _teardown(first, true);
+                    throw;
+                }
+                if (n == 0)
+                    return;
+                int redDepth = 0;
+                for (size_type m = n; m > 1; m >>= 1)
+                    ++redDepth;
+                _tree = _buildFromList(first, n, 0, redDepth);
+                _tree->setColor(BLACK);
+                _size = n;
+                _minMax->left = getMin(_tree);
+                _minMax->right = getMax(_tree);
+            }
+
+       
+            int RBTdelete(const key_type& k)
+            {
+                node_type *nodeToDelete = search(k);
+                if (nodeToDelete)
+                {
+                    _unlinkNode(nodeToDelete);
+                    _freeNode(nodeToDelete);
+                    return 1;
+                }
+                return 0;
+            }
+
+            /**
+             * Node handles. extract unlinks the node holding k without freeing
+             * it; insertNode links a detached node back, into this tree or
+             * another one using an equal allocator. A node that is not
+             * inserted again must be released with deleteNode, before the
+             * last tree using its allocator goes away. While handles are
+             * out, clear() frees a node pool node by node instead of
+             * dropping its arena.
+             */
+            node_type* extract(const key_type& k)
+            {
+                node_type *node = search(k);
+                if (node)
+                {
+                    _unlinkNode(node);
+                    _resetNode(node);
+                    _node_pool_access<node_allocator>::detach(_myNodeAlloc);
+                }
+                return node;
+            }
+
+            /* On a duplicate key node stays with the caller; second is false. */
+            std::pair<node_type*, bool> insertNode(node_type* node)
+            {
+                node_type* parent;
+                bool       toLeft;
+                node_type* found = _findInsertPos(node->value.first, parent, toLeft);
+
+                if (found)
+                    return std::make_pair(found, false);
+                _resetNode(node);
+                _insertAt(node, parent, toLeft);
+                _node_pool_access<node_allocator>::attach(_myNodeAlloc);
+                return std::make_pair(node, true);
+            }
+
+            /**
+             * Moves every element of x whose key is not in this tree over here,
+             * relinking the nodes; the others stay in x, as in std::map::merge.
+             */
+            void merge(RBtree& x)
+            {
+                if (&x == this)
+                    return;
+                bool relink = (_myNodeAlloc == x._myNodeAlloc);
+                for (node_type* node = x.getMin(x._tree); node != NULL; )
+                {
+                    node_type* next = x.getSuccessor(node);
+                    node_type* parent;
+                    bool       toLeft;
+                    if (!_findInsertPos(node->value.first, parent, toLeft))
+                    {
+                        if (relink)
+                        {
+                            x._unlinkNode(node);
+                            _resetNode(node);
+                            _insertAt(node, parent, toLeft);
+                        }
+                        else
+                        {
+                            _insertAt(_createNode(node->value), parent, toLeft);
+                            x._unlinkNode(node);
+                            x._freeNode(node);
+                        }
+                    }
+                    node = next;
+                }
+            }
+
+            /**
+             * Split/join set algebra. All of these consume x, which is left
+             * empty, and reuse its nodes when the allocators compare equal
+             * (otherwise x is copied first). union and intersection keep this
+             * tree's element for keys found in both. Each runs in
+             * O(m log(n/m + 1)) for trees of sizes m <= n.
+             */
+            void unite(RBtree& x)
+            {
+                if (&x != this)
+                    _setOperation(x, _UNION, 1);
+            }
+
+            void intersect(RBtree& x)
+            {
+                if (&x != this)
+                    _setOperation(x, _INTERSECTION, 1);
+            }
+
+            /* Removes the keys of x from this tree. */
+            void subtract(RBtree& x)
+            {
+                if (&x == this)
+                    clear();
+                else
+                    _setOperation(x, _DIFFERENCE, 1);
+            }
+
+#if __cplusplus >= 201103L
+            /**
+             * Fork-join versions of the set operations and of buildFromSorted.
+             * Each step hands one half of its work to a new thread until the
+             * thread budget is spent (0 means one per hardware thread) or the
+             * half is below FT_RBTREE_PARALLEL_CUTOFF nodes. They run serially
+             * unless rb_concurrent_allocator allows the node allocator.
+             */
+            void uniteParallel(RBtree& x, unsigned threads = 0)
+            {
+                if (&x != this)
+                    _setOperation(x, _UNION, _threadBudget(threads));
+            }
+
+            void intersectParallel(RBtree& x, unsigned threads = 0)
+            {
+                if (&x != this)
+                    _setOperation(x, _INTERSECTION, _threadBudget(threads));
+            }
+
+            void subtractParallel(RBtree& x, unsigned threads = 0)
+            {
+                if (&x == this)
+                    clear();
+                else
+                    _setOperation(x, _DIFFERENCE, _threadBudget(threads));
+            }
+
+            /* Input with equivalent keys is left to the serial buildFromSorted. */
+            template<class RandomIt>
+            void buildFromSortedParallel(RandomIt first, RandomIt last, unsigned threads = 0)
+            {
+                threads = _threadBudget(threads);
+                for (RandomIt it = first; threads > 1 && it != last && it + 1 != last; ++it)
+                    if (!_compare((*it).first, (*(it + 1)).first))
+                        threads = 1;
+                if (threads <= 1)
+                {
+                    buildFromSorted(first, last);
+                    return;
+                }
+                clear();
+                size_type n = static_cast<size_type>(last - first);
+                if (n == 0)
+                    return;
+                int redDepth = 0;
+                for (size_type m = n; m > 1; m >>= 1)
+                    ++redDepth;
+                _tree = _buildSortedParallel(first, n, 0, redDepth, threads);
+                _tree->setColor(BLACK);
+                _size = n;
+                _minMax->left = getMin(_tree);
+                _minMax->right = getMax(_tree);
+            }
+#endif
+
+            /**
+             * Appends pivot and then right to this tree; every key here must
+             * be less than pivot's and pivot's less than every key of right.
+             * pivot is a detached node (see extract). right is left empty.
+             */
+            void join(node_type* pivot, RBtree& right)
+            {
+                size_type sizeA;
+                size_type sizeB;
+                _Piece    a = _takeAll(*this, sizeA);
+                _Piece    b = _takeAll(_adoptable(right), sizeB);
+
+                _resetNode(pivot);
+                _node_pool_access<node_allocator>::attach(_myNodeAlloc);
+                _size = sizeA + sizeB + 1;
+                _finish(_join(a, pivot, b));
+            }
+
+            /**
+             * Keeps the keys less than k here and moves the greater ones to
+             * right, whose previous content is dropped. The node holding k is
+             * returned detached, or NULL. Nothing is allocated. With an
+             * augmentation that keeps subtree sizes, such as
+             * rb_order_statistic, it costs O(log n); otherwise counting the
+             * halves adds O(min(size(), right.size())).
+             */
+            node_type* split(const key_type& k, RBtree& right)
+            {
+                right.clear();
+                if (!(right._myNodeAlloc == _myNodeAlloc))
+                {
+                    right._myPairAlloc = _myPairAlloc;
+                    right._myNodeAlloc = _myNodeAlloc;
+                }
+                size_type  total;
+                _Piece     less;
+                _Piece     greater;
+                node_type* found = _split(_takeAll(*this, total), k, less, greater);
+
+                if (found)
+                {
+                    _resetNode(found);
+                    _node_pool_access<node_allocator>::detach(_myNodeAlloc);
+                    --total;
+                }
+                _finish(less);
+                right._finish(greater);
+                _size = _sizeOf(_tree, right._tree, total, _rb_bool<_rb_counts_subtrees<Augment, node_type>::value>());
+                right._size = total - _size;
+                return found;
+            }
+
+            bool isEmpty() const
+            {
+                if (_tree)
+                    return false;
+                return true;
+            }
+        
+
+            /**
+             * Only uses _compare: one comparison per level down to the lower
+             * bound, then a single equivalence check on it.
+             */
+            node_type* search(const key_type& k)const {return _search(k);}
+
+#if __cplusplus >= 201103L
+            /* Heterogeneous lookup, for comparators that define is_transparent. */
+            template<class K, class C = Compare, class = typename C::is_transparent>
+            node_type* search(const K& k)const {return _search(k);}
+#endif
+
+            /**
+             * Looks up count keys and writes the matching nodes (or NULL) to
+             * out. Keys are walked in groups of FT_RBTREE_BATCH_LANES that go
+             * down one level at a time, and each next child is prefetched
+             * while the other lanes compare, so the cache misses overlap.
+             */
+            void searchBatch(const key_type* keys, size_type count, node_type** out) const
+            {
+                node_type* current[FT_RBTREE_BATCH_LANES];
+                node_type* candidate[FT_RBTREE_BATCH_LANES];
+
+                for (size_type base = 0; base < count; base += FT_RBTREE_BATCH_LANES)
+                {
+                    size_type lanes = count - base;
+                    if (lanes > FT_RBTREE_BATCH_LANES)
+                        lanes = FT_RBTREE_BATCH_LANES;
+                    for (size_type i = 0; i < lanes; ++i)
+                    {
+                        current[i] = _tree;
+                        candidate[i] = NULL;
+                    }
+                    FT_RBTREE_COUNT(lookups, lanes);
+                    for (bool active = (_tree != NULL); active; )
+                    {
+                        active = false;
+                        for (size_type i = 0; i < lanes; ++i)
+                        {
+                            node_type* tmp = current[i];
+                            if (tmp == NULL)
+                                continue;
+                            FT_RBTREE_COUNT(lookupComparisons, 1);
+                            if (!_compare(tmp->value.first, keys[base + i]))
+                            {
+                                candidate[i] = tmp;
+                                tmp = tmp->left;
+                            }
+                            else
+                                tmp = tmp->right;
+                            if (tmp != NULL)
+                            {
+                                FT_RBTREE_PREFETCH(tmp);
+                                active = true;
+                            }
+                            current[i] = tmp;
+                        }
+                    }
+                    for (size_type i = 0; i < lanes; ++i)
+                    {
+                        node_type* found = candidate[i];
+                        out[base + i] = (found && !_compare(keys[base + i], found->value.first)) ? found : NULL;
+                    }
+                }
+            }
+
+            node_type* getMax(node_type* subtree)const
+            {
+                node_type* tmp = subtree;
+                while (tmp && tmp->right != NULL)
+                    tmp = tmp->right;
+                return tmp;
+            }
+
+            node_type* getMin(node_type* subtree)const
+            {
+                node_type* tmp = subtree;
+                while (tmp && tmp->left != NULL)
+                    tmp = tmp->left;
+                return tmp;
+            }
+
+            node_type* getSuccessor(node_type* node)const
+            {
+                if (node->right != NULL)
+                    return getMin(node->right);
+                while (node->parent != NULL && node->isRightChild())
+                    node = node->parent;
+                return node->parent;
+            }
+
+            node_type* getPredecessor(node_type* node)const
+            {
+                if (node->left != NULL)
+                    return getMax(node->left);
+                while (node->parent != NULL && node->isLeftChild())
+                    node = node->parent;
+                return node->parent;
+            }
+
+            node_type* get_min_max() const{return(_minMax);}
+            
+            node_type* getRoot()const{return _tree;}
+
+#ifdef FT_RBTREE_STATS
+            const rb_stats& stats() const {return _stats;}
+            void resetStats() {_stats = rb_stats();}
+#endif
+
+            /**
+             * Measures the tree in one O(n) walk and checks the properties
+             * listed in the README (a bool colour is always red or black),
+             * the parent links, the key order, size() and the cached
+             * min/max along the way.
+             */
+            rb_shape shape() const
+            {
+                rb_shape                shape;
+                std::vector<_ShapeStep> stack;
+                bool                    leafSeen = false;
+
+                if (_tree != NULL)
+                {
+                    if (_tree->getColor() != BLACK)
+                        _flag(shape, "the root is red");
+                    if (_tree->parent != NULL)
+                        _flag(shape, "the root has a parent");
+                    _ShapeStep root = {_tree, 0, 0, NULL, NULL};
+                    stack.push_back(root);
+                }
+                while (!stack.empty())
+                {
+                    _ShapeStep       step = stack.back();
+                    const node_type* node = step.node;
+                    size_t           blacks = step.blacks + (node->getColor() == BLACK);
+
+                    stack.pop_back();
+                    ++shape.size;
+                    if (shape.depths.size() <= step.depth)
+                        shape.depths.resize(step.depth + 1, 0);
+                    ++shape.depths[step.depth];
+                    if ((step.low != NULL && !_compare(step.low->value.first, node->value.first))
+                        || (step.high != NULL && !_compare(node->value.first, step.high->value.first)))
+                        _flag(shape, "keys are out of order");
+
+                    const node_type* children[2] = {node->left, node->right};
+                    for (int i = 0; i < 2; ++i)
+                    {
+                        const node_type* child = children[i];
+                        if (child == NULL)
+                        {
+                            if (!leafSeen)
+                                shape.blackHeight = blacks;
+                            else if (shape.blackHeight != blacks)
+                                _flag(shape, "paths have different black heights");
+                            leafSeen = true;
+                            continue;
+                        }
+                        if (child->parent != node)
+                            _flag(shape, "a parent link is wrong");
+                        if (node->getColor() == RED && child->getColor() == RED)
+                            _flag(shape, "a red node has a red child");
+                        _ShapeStep next = {child, step.depth + 1, blacks, (i == 0) ? step.low : node, (i == 0) ? node : step.high};
+                        stack.push_back(next);
+                    }
+                }
+                shape.height = shape.depths.size();
+                if (shape.size != _size)
+                    _flag(shape, "size() does not match the nodes");
+                if (_minMax->left != getMin(_tree) || _minMax->right != getMax(_tree))
+                    _flag(shape, "the cached min/max is stale");
+                return shape;
+            }
+
+            bool checkInvariants() const {return shape().violation == NULL;}
+
+            /**
+             * The traversals below insert the values of another tree's
+             * subtree into this one. They walk the parent links and never
+             * climb above node, so they need no stack.
+             */
+            void postorder(node_type* node)
+            {
+                if (node == NULL)
+                    return;
+                node_type* tmp = _firstPostorder(node);
+                while (true)
+                {
+                    RBTinsert(tmp->value);
+                    if (tmp == node)
+                        return;
+                    if (tmp->isLeftChild() && tmp->parent->right != NULL)
+                        tmp = _firstPostorder(tmp->parent->right);
+                    else
+                        tmp = tmp->parent;
+                }
+            }
+
+            void inorder(node_type* node)
+            {
+                if (node == NULL)
+                    return;
+                for (node_type* tmp = getMin(node); tmp != NULL; )
+                {
+                    RBTinsert(tmp->value);
+                    if (tmp->right != NULL)
+                        tmp = getMin(tmp->right);
+                    else
+                    {
+                        while (tmp != node && tmp->isRightChild())
+                            tmp = tmp->parent;
+                        tmp = (tmp == node) ? NULL : static_cast<node_type*>(tmp->parent);
+                    }
+                }
+            }
+
+            void preorder(node_type* node)
+            {
+                node_type* tmp = node;
+
+                while (tmp != NULL)
+                {
+                    RBTinsert(tmp->value);
+                    if (tmp->left != NULL)
+                        tmp = tmp->left;
+                    else if (tmp->right != NULL)
+                        tmp = tmp->right;
+                    else
+                    {
+                        while (tmp != node && (tmp->isRightChild() || tmp->parent->right == NULL))
+                            tmp = tmp->parent;
+                        tmp = (tmp == node) ? NULL : tmp->parent->right;
+                    }
+                }
+            }
+
+        /**
+         * 
+         *  =============================== display the tree ===============================  
+         */
+
+        // void	display_tree(const std::string &prefix, node_type* node, bool isLeft)
+        // {
+		//     if(node != NULL)
+		//     {
+        //         std::cout << prefix;
+        //         std::cout << (isLeft?"├──" : "└──");
+        //         std::cout << "|" << node->data->first << " : " <<node->data->second << " : ";
+        //         (node->color == 1)? std::cout<<"RED" :std::cout<<"BLACK";
+        //         std::cout<<std::endl;
+
+        //         display_tree(prefix+(isLeft?"│   "
+        //             : "    "),
+		//         node->left, true);
+        //             display_tree(prefix+(isLeft?"│   "
+        //             : "    "),
+		//         node->right, false);
+		//     }
+	    // }
+        
+	    // void	display_tree(){
+		//     std::cout << std::endl;
+		//     display_tree("$", _tree, false);
+          
+	    // }
+        size_type size()const{return _size;}
+        size_type max_size()const {return _myNodeAlloc.max_size();}
+
+        iterator        begin() {return iterator(_tree ? _minMax->left : _minMax, _minMax);}
+        const_iterator  begin() const {return const_iterator(_tree ? _minMax->left : _minMax, _minMax);}
+        iterator        end() {return iterator(_minMax, _minMax);}
+        const_iterator  end() const {return const_iterator(_minMax, _minMax);}
+
+        /* First element whose key is not less than k. */
+        iterator        lower_bound(const key_type& k) {return iterator(_lowerBound(k), _minMax);}
+        const_iterator  lower_bound(const key_type& k) const {return const_iterator(_lowerBound(k), _minMax);}
+
+        /* First element whose key is greater than k. */
+        iterator        upper_bound(const key_type& k) {return iterator(_upperBound(k), _minMax);}
+        const_iterator  upper_bound(const key_type& k) const {return const_iterator(_upperBound(k), _minMax);}
+
+        std::pair<iterator, iterator> equal_range(const key_type& k)
+        {
+            return std::make_pair(lower_bound(k), upper_bound(k));
+        }
+
+        std::pair<const_iterator, const_iterator> equal_range(const key_type& k) const
+        {
+            return std::make_pair(lower_bound(k), upper_bound(k));
+        }
+
+#if __cplusplus >= 201103L
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        iterator        lower_bound(const K& k) {return iterator(_lowerBound(k), _minMax);}
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const_iterator  lower_bound(const K& k) const {return const_iterator(_lowerBound(k), _minMax);}
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        iterator        upper_bound(const K& k) {return iterator(_upperBound(k), _minMax);}
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        const_iterator  upper_bound(const K& k) const {return const_iterator(_upperBound(k), _minMax);}
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        std::pair<iterator, iterator> equal_range(const K& k)
+        {
+            return std::make_pair(iterator(_lowerBound(k), _minMax), iterator(_upperBound(k), _minMax));
+        }
+
+        template<class K, class C = Compare, class = typename C::is_transparent>
+        std::pair<const_iterator, const_iterator> equal_range(const K& k) const
+        {
+            return std::make_pair(const_iterator(_lowerBound(k), _minMax), const_iterator(_upperBound(k), _minMax));
+        }
+#endif
+
+        /**
+         * Calls visit on every value with a key in [lo, hi), in order, and
+         * returns the visitor like std::for_each. Nothing is allocated.
+         */
+        template<class Visitor>
+        Visitor rangeScan(const key_type& lo, const key_type& hi, Visitor visit) const
+        {
+            const_iterator last = end();
+            for (const_iterator it = lower_bound(lo); it != last && _compare(it->first, hi); ++it)
+                visit(*it);
+            return visit;
+        }
+
+        /**
+         * Reads the tree in key order a batch at a time: read(out, count)
+         * copies up to count values to out and returns how many, 0 once
+         * the end is reached. Like a recursive walk it reaches each node
+         * from its parent, but keeps the path in a fixed array sized for
+         * the deepest possible tree, so it can stop between batches. Any
+         * insert or erase invalidates it.
+         */
+        class batch_cursor
+        {
+            public:
+                batch_cursor():_depth(0){}
+
+                template<class OutputIt>
+                size_type read(OutputIt out, size_type count)
+                {
+                    size_type done = 0;
+
+                    for (; done < count && _depth > 0; ++done)
+                    {
+                        node_type* node = _path[--_depth];
+                        *out = node->value;
+                        ++out;
+                        _pushLeft(node->right);
+                    }
+                    return done;
+                }
+
+                bool atEnd() const {return _depth == 0;}
+
+            private:
+                friend class RBtree;
+
+                /* A red-black tree of n nodes is at most 2 log2(n + 1) deep. */
+                static const int _MAX_DEPTH = 2 * std::numeric_limits<size_type>::digits;
+
+                void _pushLeft(node_type* node)
+                {
+                    for (; node != NULL; node = node->left)
+                        _path[_depth++] = node;
+                }
+
+                node_type*  _path[_MAX_DEPTH];
+                int         _depth;
+        };
+
+        /* A cursor at the smallest element, or at the first key not less than lo. */
+        batch_cursor    cursor() const
+        {
+            batch_cursor cursor;
+            cursor._pushLeft(_tree);
+            return cursor;
+        }
+
+        batch_cursor    cursor(const key_type& lo) const
+        {
+            batch_cursor cursor;
+            for (node_type* tmp = _tree; tmp != NULL; )
+            {
+                if (!_compare(tmp->value.first, lo))
+                {
+                    cursor._path[cursor._depth++] = tmp;
+                    tmp = tmp->left;
+                }
+                else
+                    tmp = tmp->right;
+            }
+            return cursor;
+        }
+
+        /**
+         * Order statistics, O(log n); they need an augmentation that keeps
+         * subtree sizes such as rb_order_statistic.
+         * select(k) is the k-th smallest element (from 0), NULL if k >= size().
+         */
+        node_type* select(size_type k) const
+        {
+            node_type* tmp = _tree;
+
+            while (tmp != NULL)
+            {
+                size_type leftSize = Augment::count(tmp->left);
+                if (k < leftSize)
+                    tmp = tmp->left;
+                else if (k == leftSize)
+                    return tmp;
+                else
+                {
+                    k -= leftSize + 1;
+                    tmp = tmp->right;
+                }
+            }
+            return NULL;
+        }
+
+        /**
+         * Combines the aggregates of every element with a key in [lo, hi),
+         * in key order, in O(log n). Walks down to the node where the
+         * bounds split, then takes whole subtrees along both boundary paths.
+         */
+        typename Augment::aggregate_type reduce(const key_type& lo, const key_type& hi) const
+        {
+            node_type* split = _tree;
+
+            while (split != NULL)
+            {
+                if (_compare(split->value.first, lo))
+                    split = split->right;
+                else if (!_compare(split->value.first, hi))
+                    split = split->left;
+                else
+                    break;
+            }
+            if (split == NULL)
+                return Augment::identity();
+
+            typename Augment::aggregate_type left = Augment::identity();
+            for (node_type* tmp = split->left; tmp != NULL; )
+            {
+                if (_compare(tmp->value.first, lo))
+                    tmp = tmp->right;
+                else
+                {
+                    left = Augment::combine(Augment::combine(Augment::lift(tmp), Augment::aggregate(tmp->right)), left);
+                    tmp = tmp->left;
+                }
+            }
+
+            typename Augment::aggregate_type right = Augment::identity();
+            for (node_type* tmp = split->right; tmp != NULL; )
+            {
+                if (!_compare(tmp->value.first, hi))
+                    tmp = tmp->left;
+                else
+                {
+                    right = Augment::combine(right, Augment::combine(Augment::aggregate(tmp->left), Augment::lift(tmp)));
+                    tmp = tmp->right;
+                }
+            }
+            return Augment::combine(left, Augment::combine(Augment::lift(split), right));
+        }
+
+        /* Number of keys less than k. */
+        size_type rank(const key_type& k) const
+        {
+            node_type* tmp = _tree;
+            size_type  result = 0;
+
+            while (tmp != NULL)
+            {
+                if (_compare(tmp->value.first, k))
+                {
+                    result += Augment::count(tmp->left) + 1;
+                    tmp = tmp->right;
+                }
+                else
+                    tmp = tmp->left;
+            }
+            return result;
+        }
+        
+        private:
+
+            /* A node still to visit in shape(), with the keys that bound its subtree. */
+            struct _ShapeStep
+            {
+                const node_type*    node;
+                size_t              depth;
+                size_t              blacks;
+                const node_type*    low;
+                const node_type*    high;
+            };
+
+            static void _flag(rb_shape& shape, const char* violation)
+            {
+                if (shape.violation == NULL)
+                    shape.violation = violation;
+            }
+
+            /* A detached subtree and the number of black nodes on its paths, root included. */
+            struct _Piece
+            {
+                node_type*  root;
+                int         blackHeight;
+            };
+
+            static _Piece _makePiece(node_type* root, int blackHeight)
+            {
+                _Piece piece;
+
+                piece.root = root;
+                piece.blackHeight = blackHeight;
+                if (root != NULL)
+                    root->parent = NULL;
+                return piece;
+            }
+
+            static int _blackHeight(const node_type* node)
+            {
+                int height = 0;
+
+                for (; node != NULL; node = node->left)
+                    height += (node->getColor() == BLACK);
+                return height;
+            }
+
+            /* Empties t and hands over its nodes. */
+            _Piece _takeAll(RBtree& t, size_type& size)
+            {
+                _Piece piece = _makePiece(t._tree, _blackHeight(t._tree));
+
+                size = t._size;
+                t._tree = NULL;
+                t._size = 0;
+                t._minMax->left = NULL;
+                t._minMax->right = NULL;
+                return piece;
+            }
+
+            /* Makes x's nodes ours to keep, copying them if our allocators differ. */
+            RBtree& _adoptable(RBtree& x)
+            {
+                if (!(_myNodeAlloc == x._myNodeAlloc))
+                {
+                    RBtree copy;
+                    copy._myPairAlloc = _myPairAlloc;
+                    copy._myNodeAlloc = _myNodeAlloc;
+                    copy._compare = x._compare;
+                    copy._copyFrom(x);
+                    x.swap(copy);
+                }
+                return x;
+            }
+
+            void _finish(_Piece piece)
+            {
+                _tree = piece.root;
+                if (_tree != NULL)
+                {
+                    _tree->parent = NULL;
+                    _tree->setColor(BLACK);
+                }
+                _minMax->left = getMin(_tree);
+                _minMax->right = getMax(_tree);
+            }
+
+            void _freeNode(node_type* node)
+            {
+                _myNodeAlloc.destroy(node);
+                _myNodeAlloc.deallocate(node, 1);
+                FT_RBTREE_COUNT(deallocations, 1);
+            }
+
+            void _resetNode(node_type* node)
+            {
+                node->left = NULL;
+                node->right = NULL;
+                node->parent = NULL;
+                node->setColor(RED);
+                Augment::update(node);
+            }
+
+            void _dropNode(node_type* node)
+            {
+                _freeNode(node);
+                --_size;
+            }
+
+            void _dropPiece(_Piece piece)
+            {
+                _size -= _teardown(piece.root, true);
+            }
+
+            /* Size of a, read from the subtree size its root keeps. */
+            size_type _sizeOf(node_type* a, node_type*, size_type, _rb_bool<true>) const
+            {
+                return Augment::count(a);
+            }
+
+            /* Size of a, walking a and b in step, given that they hold total nodes. */
+            size_type _sizeOf(node_type* a, node_type* b, size_type total, _rb_bool<false>) const
+            {
+                size_type count = 0;
+
+                for (a = getMin(a), b = getMin(b); a != NULL && b != NULL; a = getSuccessor(a), b = getSuccessor(b))
+                    ++count;
+                return (a == NULL) ? count : total - count;
+            }
+
+            /**
+             * Joins left, k and right, all keys in that order. Both roots are
+             * made black; if the black heights match, k is a red root over
+             * both. Otherwise k goes down the spine of the taller tree facing
+             * the other one until it reaches a black node of the same black
+             * height, takes its place as a red node with that node and the
+             * shorter tree as children, and the insert fix-up repairs a red
+             * parent. Costs O(height difference), plus the path refresh when
+             * an augmentation is on.
+             */
+            _Piece _join(_Piece left, node_type* k, _Piece right)
+            {
+                _blackenRoot(left);
+                _blackenRoot(right);
+                k->parent = NULL;
+                k->setColor(RED);
+                if (left.blackHeight == right.blackHeight)
+                {
+                    _linkChildren(k, left.root, right.root);
+                    return _makePiece(k, left.blackHeight);
+                }
+
+                bool       leftTaller = (left.blackHeight > right.blackHeight);
+                _Piece     taller = leftTaller ? left : right;
+                int        target = leftTaller ? right.blackHeight : left.blackHeight;
+                int        height = taller.blackHeight;
+                node_type* parent = NULL;
+                node_type* spine = taller.root;
+
+                while (spine != NULL && (spine->getColor() == RED || height != target))
+                {
+                    height -= (spine->getColor() == BLACK);
+                    parent = spine;
+                    spine = leftTaller ? spine->right : spine->left;
+                }
+                if (leftTaller)
+                {
+                    _linkChildren(k, spine, right.root);
+                    parent->right = k;
+                }
+                else
+                {
+                    _linkChildren(k, left.root, spine);
+                    parent->left = k;
+                }
+                k->parent = parent;
+
+                node_type* saved = _tree;
+                _tree = taller.root;
+                _updatePath(parent);
+                int grown = _fixBalanceAfterInsert(k) ? 1 : 0;
+                _Piece joined = _makePiece(_tree, taller.blackHeight + grown);
+                _tree = saved;
+                return joined;
+            }
+
+            void _blackenRoot(_Piece& piece)
+            {
+                if (piece.root != NULL && piece.root->getColor() == RED)
+                {
+                    piece.root->setColor(BLACK);
+                    ++piece.blackHeight;
+                }
+            }
+
+            void _linkChildren(node_type* node, node_type* left, node_type* right)
+            {
+                node->left = left;
+                node->right = right;
+                if (left != NULL)
+                    left->parent = node;
+                if (right != NULL)
+                    right->parent = node;
+                Augment::update(node);
+            }
+
+            /* Joins two trees without a pivot by borrowing the max of left. */
+            _Piece _join2(_Piece left, _Piece right)
+            {
+                if (left.root == NULL)
+                    return right;
+                if (right.root == NULL)
+                    return left;
+                node_type* last;
+                _Piece     rest = _splitLast(left, last);
+                return _join(rest, last, right);
+            }
+
+            _Piece _splitLast(_Piece tree, node_type* &last)
+            {
+                node_type* node = tree.root;
+                int        childHeight = tree.blackHeight - (node->getColor() == BLACK);
+                _Piece     left = _makePiece(node->left, childHeight);
+
+                if (node->right == NULL)
+                {
+                    last = node;
+                    return left;
+                }
+                _Piece rest = _splitLast(_makePiece(node->right, childHeight), last);
+                return _join(left, node, rest);
+            }
+
+            /**
+             * Splits tree around k into the keys less than k and the keys
+             * greater; the node holding k, if any, is returned unlinked.
+             */
+            node_type* _split(_Piece tree, const key_type& k, _Piece& less, _Piece& greater)
+            {
+                if (tree.root == NULL)
+                {
+                    less = tree;
+                    greater = tree;
+                    return NULL;
+                }
+                node_type* node = tree.root;
+                int        childHeight = tree.blackHeight - (node->getColor() == BLACK);
+                _Piece     left = _makePiece(node->left, childHeight);
+                _Piece     right = _makePiece(node->right, childHeight);
+                _Piece     middle;
+                node_type* found;
+
+                if (_compare(k, node->value.first))
+                {
+                    found = _split(left, k, less, middle);
+                    greater = _join(middle, node, right);
+                }
+                else if (_compare(node->value.first, k))
+                {
+                    found = _split(right, k, middle, greater);
+                    less = _join(left, node, middle);
+                }
+                else
+                {
+                    less = left;
+                    greater = right;
+                    found = node;
+                }
+                return found;
+            }
+
+            enum _SetOperation { _UNION, _INTERSECTION, _DIFFERENCE };
+
+            void _setOperation(RBtree& x, _SetOperation op, unsigned threads)
+            {
+                size_type sizeA;
+                size_type sizeB;
+                _Piece    a = _takeAll(*this, sizeA);
+                _Piece    b = _takeAll(_adoptable(x), sizeB);
+
+                _size = sizeA + sizeB;
+                _finish(_combine(op, a, b, threads));
+            }
+
+            _Piece _combine(_SetOperation op, _Piece a, _Piece b, unsigned threads)
+            {
+                if (op == _UNION)
+                    return _union(a, b, threads);
+                if (op == _INTERSECTION)
+                    return _intersection(a, b, threads);
+                return _difference(a, b, threads);
+            }
+
+#ifdef FT_RBTREE_STATS
+            /* Folds in the counts of a scratch tree that did part of the work. */
+            void _addStats(const rb_stats& other)
+            {
+                FT_RBTREE_COUNT(lookups, other.lookups);
+                FT_RBTREE_COUNT(lookupComparisons, other.lookupComparisons);
+                FT_RBTREE_COUNT(rotations, other.rotations);
+                FT_RBTREE_COUNT(recolorings, other.recolorings);
+                FT_RBTREE_COUNT(insertRedUncle, other.insertRedUncle);
+                FT_RBTREE_COUNT(insertBlackUncle, other.insertBlackUncle);
+                FT_RBTREE_COUNT(eraseRedSibling, other.eraseRedSibling);
+                FT_RBTREE_COUNT(eraseRedNephew, other.eraseRedNephew);
+                FT_RBTREE_COUNT(eraseBlackNephews, other.eraseBlackNephews);
+                FT_RBTREE_COUNT(allocations, other.allocations);
+                FT_RBTREE_COUNT(deallocations, other.deallocations);
+            }
+#endif
+
+            /**
+             * Combines the left halves and the right halves of a step. With
+             * threads to spare and enough nodes, the left ones go to another
+             * thread working on a scratch tree, since _join rebalances
+             * through _tree and the drops count down _size.
+             */
+            void _combineHalves(_SetOperation op, _Piece aLeft, _Piece bLeft, _Piece& left,
+                                _Piece aRight, _Piece bRight, _Piece& right, unsigned threads)
+            {
+#if __cplusplus >= 201103L
+                if (threads > 1 && (_worthForking(aLeft) || _worthForking(bLeft)))
+                {
+                    RBtree scratch;
+                    scratch._myPairAlloc = _myPairAlloc;
+                    scratch._myNodeAlloc = _myNodeAlloc;
+                    scratch._compare = _compare;
+                    _forkJoin([&] { left = scratch._combine(op, aLeft, bLeft, threads / 2); },
+                              [&] { right = _combine(op, aRight, bRight, threads - threads / 2); });
+                    /* scratch._size went below zero by what it dropped */
+                    _size += scratch._size;
+                    scratch._size = 0;
+#ifdef FT_RBTREE_STATS
+                    _addStats(scratch._stats);
+#endif
+                    return;
+                }
+#endif
+                left = _combine(op, aLeft, bLeft, threads);
+                right = _combine(op, aRight, bRight, threads);
+            }
+
+            _Piece _union(_Piece a, _Piece b, unsigned threads)
+            {
+                if (a.root == NULL)
+                    return b;
+                if (b.root == NULL)
+                    return a;
+                node_type* node = a.root;
+                int        childHeight = a.blackHeight - (node->getColor() == BLACK);
+                _Piece     aLeft = _makePiece(node->left, childHeight);
+                _Piece     aRight = _makePiece(node->right, childHeight);
+                _Piece     bLeft;
+                _Piece     bRight;
+                node_type* duplicate = _split(b, node->value.first, bLeft, bRight);
+
+                if (duplicate != NULL)
+                    _dropNode(duplicate);
+                _Piece left;
+                _Piece right;
+                _combineHalves(_UNION, aLeft, bLeft, left, aRight, bRight, right, threads);
+                return _join(left, node, right);
+            }
+
+            _Piece _intersection(_Piece a, _Piece b, unsigned threads)
+            {
+                if (a.root == NULL || b.root == NULL)
+                {
+                    _dropPiece(a);
+                    _dropPiece(b);
+                    return _makePiece(NULL, 0);
+                }
+                node_type* node = a.root;
+                int        childHeight = a.blackHeight - (node->getColor() == BLACK);
+                _Piece     aLeft = _makePiece(node->left, childHeight);
+                _Piece     aRight = _makePiece(node->right, childHeight);
+                _Piece     bLeft;
+                _Piece     bRight;
+                node_type* match = _split(b, node->value.first, bLeft, bRight);
+                _Piece     left;
+                _Piece     right;
+
+                _combineHalves(_INTERSECTION, aLeft, bLeft, left, aRight, bRight, right, threads);
+
+                if (match != NULL)
+                {
+                    _dropNode(match);
+                    return _join(left, node, right);
+                }
+                _dropNode(node);
+                return _join2(left, right);
+            }
+
+            _Piece _difference(_Piece a, _Piece b, unsigned threads)
+            {
+                if (a.root == NULL || b.root == NULL)
+                {
+                    _dropPiece(b);
+                    return a;
+                }
+                node_type* node = b.root;
+                int        childHeight = b.blackHeight - (node->getColor() == BLACK);
+                _Piece     bLeft = _makePiece(node->left, childHeight);
+                _Piece     bRight = _makePiece(node->right, childHeight);
+                _Piece     aLeft;
+                _Piece     aRight;
+                node_type* match = _split(a, node->value.first, aLeft, aRight);
+
+                _dropNode(node);
+                if (match != NULL)
+                    _dropNode(match);
+                _Piece left;
+                _Piece right;
+                _combineHalves(_DIFFERENCE, aLeft, bLeft, left, aRight, bRight, right, threads);
+                return _join2(left, right);
+            }
+
+            /* Deepest node reached by going left when possible, else right. */
+            node_type* _firstPostorder(node_type* node) const
+            {
+                while (node->left != NULL || node->right != NULL)
+                    node = (node->left != NULL) ? node->left : node->right;
+                return node;
+            }
+
+            template<class K>
+            node_type* _search(const K& k) const
+            {
+                node_type* found = _lowerBound(k);
+
+                if (found != _minMax && !_compare(k, found->value.first))
+                    return found;
+                return NULL;
+            }
+
+            template<class K>
+            node_type* _lowerBound(const K& k) const
+            {
+                node_type* tmp = _tree;
+                node_type* result = _minMax;
+
+                FT_RBTREE_COUNT(lookups, 1);
+
+                while (tmp != NULL)
+                {
+                    FT_RBTREE_COUNT(lookupComparisons, 1);
+                    if (!_compare(tmp->value.first, k))
+                    {
+                        result = tmp;
+                        tmp = tmp->left;
+                    }
+                    else
+                        tmp = tmp->right;
+                }
+                return result;
+            }
+
+            template<class K>
+            node_type* _upperBound(const K& k) const
+            {
+                node_type* tmp = _tree;
+                node_type* result = _minMax;
+
+                FT_RBTREE_COUNT(lookups, 1);
+
+                while (tmp != NULL)
+                {
+                    FT_RBTREE_COUNT(lookupComparisons, 1);
+                    if (_compare(k, tmp->value.first))
+                    {
+                        result = tmp;
+                        tmp = tmp->left;
+                    }
+                    else
+                        tmp = tmp->right;
+                }
+                return result;
+            }
+
+            void _initSentinel()
+            {
+                _minMaxStorage = _SentinelStorage();
+                _minMax = reinterpret_cast<node_type*>(_minMaxStorage.bytes);
+                _minMax->left = NULL;
+                _minMax->right = NULL;
+                _minMax->parent = NULL;
+                _minMax->setColor(BLACK);
+            }
+
+            /**
+             * Structural copy: duplicates shape and colours node by node in
+             * O(n), without comparisons or rotations. Expects an empty tree.
+             */
+            void _copyFrom(const RBtree& x)
+            {
+                if (x._tree == NULL)
+                    return;
+                _tree = _clone(x._tree, NULL);
+                _size = x._size;
+                _minMax->left = getMin(_tree);
+                _minMax->right = getMax(_tree);
+            }
+
+            node_type* _clone(const node_type* src, node_type* parent)
+            {
+                if (src == NULL)
+                    return NULL;
+                node_type* node = _createNode(src->value);
+                node->setColor(src->getColor());
+                node->parent = parent;
+                try
+                {
+                    node->left = _clone(src->left, node);
+                    node->right = _clone(src->right, node);
+                }
+                catch (...)
+                {
+                    delete_all(node);
+                    throw;
+                }
+                Augment::update(node);
+                return node;
+            }
+
+            class _ValuePtrCompare
+            {
+                public:
+                    _ValuePtrCompare(const Compare& compare):_compare(compare){}
+                    bool operator()(const value_type* a, const value_type* b) const {return _compare(a->first, b->first);}
+                private:
+                    Compare _compare;
+            };
+
+            /* Walks a sequence of value pointers as if it held the values. */
+            template<class It>
+            class _PtrIterator
+            {
+                public:
+                    explicit _PtrIterator(It it):_it(it){}
+                    const value_type& operator*() const {return **_it;}
+                    const value_type* operator->() const {return *_it;}
+                    _PtrIterator& operator++(){++_it; return *this;}
+                    bool operator==(const _PtrIterator& x) const {return _it == x._it;}
+                    bool operator!=(const _PtrIterator& x) const {return _it != x._it;}
+                private:
+                    It _it;
+            };
+
+            template<class ForwardIt>
+            void _skipEquivalent(ForwardIt& it, const ForwardIt& last) const
+            {
+                ForwardIt prev = it;
+                ++it;
+                while (it != last && !_compare((*prev).first, (*it).first))
+                    ++it;
             }
 
-            RBtree(const RBtree& x):_tree(NULL),_myPairAlloc(x._myPairAlloc), _myNodeAlloc(x._myNodeAlloc)
+            /* Orders run indices for a max-heap so the smallest head, then the earliest run, is on top. */
+            template<class InputIt>
+            class _RunCompare
             {
-                _minMax = _myNodeAlloc.allocate(1);
-                _minMax->left = NULL;
-                _minMax->right = NULL;
-                if (x._tree == NULL)
-                    return;
-                preorder(x._tree);
-                _size = x._size;
-            }
+                public:
+                    _RunCompare(const std::vector<std::pair<InputIt, InputIt> >& heads, const Compare& compare)
+                        :_heads(heads), _compare(compare){}
 
-            RBtree& operator=(const RBtree& x)
+                    bool operator()(size_type a, size_type b) const
+                    {
+                        if (_compare((*_heads[b].first).first, (*_heads[a].first).first))
+                            return true;
+                        return a > b && !_compare((*_heads[a].first).first, (*_heads[b].first).first);
+                    }
+
+                private:
+                    const std::vector<std::pair<InputIt, InputIt> >&    _heads;
+                    Compare                                             _compare;
+            };
+
+            /**
+             * Links the n next nodes of list, chained through right, into a
+             * subtree shaped like the one _buildSorted makes. Allocates
+             * nothing, so it cannot fail half way.
+             */
+            node_type* _buildFromList(node_type*& list, size_type n, int depth, int redDepth)
             {
-                delete_all(_tree);
-                _myPairAlloc = x._myPairAlloc;
-                _myNodeAlloc = x._myNodeAlloc;
-                _minMax->left = NULL;
-                _minMax->right = NULL;
-                _compare = x._compare;
-                _compare = x._compare;
-                inorder(x._tree);
-                _size = x._size;
-                return (*this);
+                if (n == 0)
+                    return NULL;
+                size_type leftSize = (n - 1) / 2;
+                node_type* left = _buildFromList(list, leftSize, depth + 1, redDepth);
+                node_type* node = list;
+                list = list->right;
+                node->left = left;
+                if (left != NULL)
+                    left->parent = node;
+                node->right = _buildFromList(list, n - leftSize - 1, depth + 1, redDepth);
+                if (node->right != NULL)
+                    node->right->parent = node;
+                node->setColor((depth == redDepth) ? RED : BLACK);
+                Augment::update(node);
+                return node;
             }
 
-            void clear(){
-                if (_tree != NULL)
-                    delete_all(_tree);
-                _size = 0;
-                _tree = NULL;
+            /**
+             * Builds the n next distinct values of it as a subtree rooted at
+             * depth. Nodes on redDepth, the only incomplete level, are red.
+             */
+            template<class ForwardIt>
+            node_type* _buildSorted(ForwardIt& it, const ForwardIt& last, size_type n, int depth, int redDepth)
+            {
+                if (n == 0)
+                    return NULL;
+                size_type leftSize = (n - 1) / 2;
+                node_type* left = _buildSorted(it, last, leftSize, depth + 1, redDepth);
+                node_type* node;
+                try
+                {
+                    node = _createNode(*it);
+                }
+                catch (...)
+                {
+                    _teardown(left, true);
+                    throw;
+                }
+                _skipEquivalent(it, last);
+                node->left = left;
+                if (left != NULL)
+                    left->parent = node;
+                try
+                {
+                    node->right = _buildSorted(it, last, n - leftSize - 1, depth + 1, redDepth);
+                }
+                catch (...)
+                {
+                    _teardown(node, true);
+                    throw;
+                }
+                if (node->right != NULL)
+                    node->right->parent = node;
+                node->setColor((depth == redDepth) ? RED : BLACK);
+                Augment::update(node);
+                return node;
             }
 
-            ~RBtree(){this->clear();_myNodeAlloc.deallocate(_minMax,1);}
+#if __cplusplus >= 201103L
+            unsigned _threadBudget(unsigned threads) const
+            {
+                if (!rb_concurrent_allocator<node_allocator>::value)
+                    return 1;
+                if (threads == 0)
+                    threads = std::thread::hardware_concurrency();
+                return (threads == 0) ? 1 : threads;
+            }
 
-            void deleteNode(TNode<value_type> * &node)
+            /* A subtree of black height h holds at least 2^h - 1 nodes. */
+            static bool _worthForking(_Piece piece)
             {
-                _myPairAlloc.destroy(node->data);
-                _myPairAlloc.deallocate(node->data, 1);
-                _myNodeAlloc.destroy(node);
-                _myNodeAlloc.deallocate(node, 1);
+                return piece.blackHeight >= std::numeric_limits<size_type>::digits
+                    || (size_type(1) << piece.blackHeight) > FT_RBTREE_PARALLEL_CUTOFF;
             }
 
-            void delete_all(TNode<value_type>* &node)
+            /**
+             * Runs left on a new thread and right on this one, then waits for
+             * both; an exception from either is rethrown once both are done.
+             * If no thread can be started, both run here.
+             */
+            template<class Left, class Right>
+            static void _forkJoin(Left left, Right right)
             {
-                if (node != NULL)
+                std::exception_ptr error;
+                std::thread        worker;
+
+                try
                 {
-                    delete_all(node->left);
-                    delete_all(node->right);
-                    _myPairAlloc.destroy(node->data);
-                    _myPairAlloc.deallocate(node->data, 1);
-                    node->data = NULL;
-                    _myNodeAlloc.deallocate(node, 1);
-                    node = NULL;
+                    worker = std::thread([&] {
+                        try
+                        {
+                            left();
+                        }
+                        catch (...)
+                        {
+                            error = std::current_exception();
+                        }
+                    });
                 }
-                _minMax->left = NULL;
-                _minMax->right = NULL;
-                _size = 0;
+                catch (const std::system_error&)
+                {
+                    left();
+                    right();
+                    return;
+                }
+                try
+                {
+                    right();
+                }
+                catch (...)
+                {
+                    worker.join();
+                    throw;
+                }
+                worker.join();
+                if (error)
+                    std::rethrow_exception(error);
             }
 
-            void swap(RBtree &x)
+            /* _buildSorted over distinct keys, the two sides of each step in parallel. */
+            template<class RandomIt>
+            node_type* _buildSortedParallel(RandomIt first, size_type n, int depth, int redDepth, unsigned threads)
             {
-                TNode<value_type>*tmp = _tree;
-                _tree = x._tree;
-                x._tree = tmp;
-                
-                size_t sizetmp = _size;
-                _size = x._size;
-                x._size = sizetmp;
-                TNode<value_type>*tmpmM = _minMax;
+                if (threads <= 1 || n < FT_RBTREE_PARALLEL_CUTOFF)
+                {
+                    RandomIt it = first;
+                    return _buildSorted(it, first + n, n, depth, redDepth);
+                }
+                size_type  leftSize = (n - 1) / 2;
+                node_type* left = NULL;
+                node_type* right = NULL;
+                node_type* node;
 
-                _minMax = x._minMax;
-                x._minMax = tmpmM;
+                try
+                {
+                    _forkJoin([&] { left = _buildSortedParallel(first, leftSize, depth + 1, redDepth, threads / 2); },
+                              [&] { right = _buildSortedParallel(first + leftSize + 1, n - leftSize - 1, depth + 1,
+                                                                 redDepth, threads - threads / 2); });
+                    node = _createNode(*(first + leftSize));
+                }
+                catch (...)
+                {
+                    _teardown(left, true);
+                    _teardown(right, true);
+                    throw;
+                }
+                _linkChildren(node, left, right);
+                node->setColor((depth == redDepth) ? RED : BLACK);
+                return node;
+            }
+#endif
 
+            void _destroyValues(node_type* node)
+            {
+                _teardown(node, false);
             }
-    
-            void RBTinsert(const value_type& val)
+
+            /**
+             * Destroys a subtree with O(1) extra space and no recursion: left
+             * children are rotated up until the current node has none, then it
+             * goes and its right child is next. Parent links are not used.
+             */
+            size_type _teardown(node_type* node, bool deallocate)
             {
-                if (!search(val.first))
+                size_type count = 0;
+
+                while (node != NULL)
                 {
-                    _size++;
-                    TNode<value_type>* new_element = _createNode(val);
-                    if (_tree == NULL)
+                    node_type* left = node->left;
+                    if (left != NULL)
                     {
-                        new_element->flipColor();
-                        _tree = new_element;
-                        _minMax->right = _tree;
-                        _minMax->left = _tree;
-                        return;
+                        node->left = left->right;
+                        left->right = node;
+                        node = left;
                     }
                     else
                     {
-                       TNode<value_type>* temp = _tree;
-                       TNode<value_type>* prev_temp = NULL;
-
-                       while (temp != NULL)
-                       {
-                           prev_temp = temp;
-                           if (_compare(val.first , temp->data->first))
-                                temp = temp->left;
-                            else
-                                temp = temp->right;
-                       } 
-                       new_element->parent = prev_temp;
-                        if (_compare(val.first , prev_temp->data->first))
-                            prev_temp->left = new_element;
-                        else
-                            prev_temp->right = new_element;
+                        node_type* next = node->right;
+                        _myNodeAlloc.destroy(node);
+                        if (deallocate)
+                        {
+                            _myNodeAlloc.deallocate(node, 1);
+                            FT_RBTREE_COUNT(deallocations, 1);
+                        }
+                        node = next;
+                        ++count;
                     }
-                    _fixBalanceAfterInsert(new_element);
-                    _minMax->right = getMax(getRoot());
-                    _minMax->left = getMin(getRoot());
                 }
+                return count;
             }
 
-       
-            int RBTdelete(const key_type& k)
+            node_type*   _createNode(const value_type& data)
             {
-                TNode<value_type> *nodeToDelete = search(k);
-                if (nodeToDelete)
+                node_type *new_element = _myNodeAlloc.allocate(1);
+                try
                 {
-                    --_size;
-                    if (nodeToDelete == _tree)
-                        _deleteRoot();
-                    else
-                        _BSTdelete(nodeToDelete);
-                    _minMax->right = getMax(getRoot());
-                    _minMax->left = getMin(getRoot());
-                    return 1;
+                    ::new (static_cast<void*>(new_element)) node_type(data);
                 }
-                return 0;
+                catch (...)
+                {
+                    _myNodeAlloc.deallocate(new_element, 1);
+                    throw;
+                }
+                FT_RBTREE_COUNT(allocations, 1);
+                return (new_element);
             }
-        
-            bool isEmpty() const
+
+#if __cplusplus >= 201103L
+            template<class... Args>
+            node_type*   _createNode(Args&&... args)
             {
-                if (_tree)
-                    return false;
-                return true;
+                node_type *new_element = _myNodeAlloc.allocate(1);
+                try
+                {
+                    ::new (static_cast<void*>(new_element)) node_type(typename node_type::emplace_tag(), std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    _myNodeAlloc.deallocate(new_element, 1);
+                    throw;
+                }
+                FT_RBTREE_COUNT(allocations, 1);
+                return (new_element);
             }
-        
+#endif
 
-            TNode<value_type>* search(const key_type& k)const
+            /**
+             * Single descent with one comparison per level. candidate is the
+             * last node we went right from, the only one that can hold k.
+             */
+            node_type*   _findInsertPos(const key_type& k, node_type* &parent, bool &toLeft) const
             {
-                if (_tree == NULL)
+                node_type* tmp = _tree;
+                node_type* candidate = NULL;
+
+                /* appending past the max is the common ingest pattern */
+                if (_tree != NULL && _compare(_minMax->right->value.first, k))
+                {
+                    parent = _minMax->right;
+                    toLeft = false;
                     return NULL;
-                TNode<value_type>* tmp = _tree;
-                while (tmp && tmp->data->first != k)
+                }
+                parent = NULL;
+                toLeft = true;
+                while (tmp != NULL)
                 {
-                    if (_compare(k , tmp->data->first))
+                    parent = tmp;
+                    toLeft = _compare(k, tmp->value.first);
+                    if (toLeft)
                         tmp = tmp->left;
                     else
+                    {
+                        candidate = tmp;
                         tmp = tmp->right;
+                    }
                 }
-                return tmp;
-            }
-
-            TNode<value_type>* getMax(TNode<value_type>* subtree)const
-            {
-                TNode<value_type>* tmp = subtree;
-                while (tmp && tmp->right != NULL)
-                    tmp = tmp->right;
-                return tmp;
+                if (candidate && !_compare(candidate->value.first, k))
+                    return candidate;
+                return NULL;
             }
 
-            TNode<value_type>* getMin(TNode<value_type>* subtree)const
+            /**
+             * The new key fits between hint's neighbours when it is greater
+             * than one and less than the other; the free child slot is then
+             * either on hint or on that neighbour.
+             */
+            node_type*   _findHintPos(node_type* hint, const key_type& k, node_type* &parent, bool &toLeft) const
             {
-                TNode<value_type>* tmp = subtree;
-                while (tmp && tmp->left != NULL)
-                    tmp = tmp->left;
-                return tmp;
+                if (_tree == NULL || hint == _minMax)
+                    return _findInsertPos(k, parent, toLeft);
+                if (_compare(k, hint->value.first))
+                {
+                    if (hint == _minMax->left)
+                    {
+                        parent = hint;
+                        toLeft = true;
+                        return NULL;
+                    }
+                    node_type* before = getPredecessor(hint);
+                    if (_compare(before->value.first, k))
+                    {
+                        toLeft = (before->right != NULL);
+                        parent = toLeft ? hint : before;
+                        return NULL;
+                    }
+                }
+                else if (_compare(hint->value.first, k))
+                {
+                    if (hint == _minMax->right)
+                    {
+                        parent = hint;
+                        toLeft = false;
+                        return NULL;
+                    }
+                    node_type* after = getSuccessor(hint);
+                    if (_compare(k, after->value.first))
+                    {
+                        toLeft = (hint->right != NULL);
+                        parent = toLeft ? after : hint;
+                        return NULL;
+                    }
+                }
+                else
+                    return hint;
+                return _findInsertPos(k, parent, toLeft);
             }
 
-            TNode<value_type>* get_min_max() const{return(_minMax);}
-            
-            TNode<value_type>* getRoot()const{return _tree;}
-
-            void postorder(TNode<value_type>* node)
+            void        _insertAt(node_type* new_element, node_type* parent, bool toLeft)
             {
-                if (node == NULL)
+                _size++;
+                if (parent == NULL)
+                {
+                    new_element->setColor(BLACK);
+                    _tree = new_element;
+                    _minMax->right = _tree;
+                    _minMax->left = _tree;
                     return;
-                postorder(node->left);
-                postorder(node->right);
-                RBTinsert(*(node->data));
+                }
+                new_element->parent = parent;
+                if (toLeft)
+                    parent->left = new_element;
+                else
+                    parent->right = new_element;
+                _updatePath(parent);
+                _fixBalanceAfterInsert(new_element);
+                if (toLeft && parent == _minMax->left)
+                    _minMax->left = new_element;
+                else if (!toLeft && parent == _minMax->right)
+                    _minMax->right = new_element;
             }
 
-            void inorder(TNode<value_type>* node)
+            /* The cached extremes follow the erased node to its neighbour. */
+            void        _updateMinMaxBeforeDelete(node_type* node)
             {
-                if (node == NULL)
-                    return;
-                inorder(node->left);
-                RBTinsert(*(node->data));
-                inorder(node->right);
+                if (node == _minMax->left)
+                    _minMax->left = getSuccessor(node);
+                if (node == _minMax->right)
+                    _minMax->right = getPredecessor(node);
             }
 
-            void preorder(TNode<value_type>* node)
+            /* Refreshes the augmented data from node up to the root. */
+            void        _updatePath(node_type* node)
             {
-                if (node == NULL)
+                if (!Augment::enabled)
                     return;
-                RBTinsert(*(node->data));
-                preorder(node->left);
-                preorder(node->right);
-            }
-
-        /**
-         * 
-         *  =============================== display the tree ===============================  
-         */
-
-        // void	display_tree(const std::string &prefix, TNode<value_type>* node, bool isLeft)
-        // {
-		//     if(node != NULL)
-		//     {
-        //         std::cout << prefix;
-        //         std::cout << (isLeft?"├──" : "└──");
-        //         std::cout << "|" << node->data->first << " : " <<node->data->second << " : ";
-        //         (node->color == 1)? std::cout<<"RED" :std::cout<<"BLACK";
-        //         std::cout<<std::endl;
-
-        //         display_tree(prefix+(isLeft?"│   "
-        //             : "    "),
-		//         node->left, true);
-        //             display_tree(prefix+(isLeft?"│   "
-        //             : "    "),
-		//         node->right, false);
-		//     }
-	    // }
-        
-	    // void	display_tree(){
-		//     std::cout << std::endl;
-		//     display_tree("$", _tree, false);
-          
-	    // }
-        size_type size()const{return _size;}
-        size_type max_size()const {return _myNodeAlloc.max_size();}
-        
-        private:
-
-            TNode<value_type>*   _createNode(const value_type& data)
-            {
-                TNode<value_type> *new_element = _myNodeAlloc.allocate(1);
-                _myNodeAlloc.construct(new_element);
-    
-
-                new_element->data = _myPairAlloc.allocate(1);
-                _myPairAlloc.construct(new_element->data, data);
-
-                return (new_element);
+                for (; node != NULL; node = node->parent)
+                    Augment::update(node);
             }
 
-            void        _rightRotation(TNode<value_type>* node)
+            void        _rightRotation(node_type* node)
             {
-                TNode<value_type>* parent = node->parent;
-                TNode<value_type>* left_node = node->left;
+                node_type* parent = node->parent;
+                node_type* left_node = node->left;
 
                 node->left = left_node->right;
 
@@ -387,12 +2704,15 @@ namespace ft{
                     parent->right = left_node;
                 if (left_node != NULL)
                     left_node->parent = parent;
+                Augment::update(node);
+                Augment::update(left_node);
+                FT_RBTREE_COUNT(rotations, 1);
             }
 
-            void _leftRotation(TNode<value_type>* node)
+            void _leftRotation(node_type* node)
             {
-                TNode<value_type>* right_node = node->right;
-                TNode<value_type>* parent = node->parent;
+                node_type* right_node = node->right;
+                node_type* parent = node->parent;
 
                 node->right = right_node->left;
 
@@ -411,189 +2731,254 @@ namespace ft{
                     parent->right = right_node;
                 if (right_node != NULL)
                     right_node->parent = parent;
+                Augment::update(node);
+                Augment::update(right_node);
+                FT_RBTREE_COUNT(rotations, 1);
         }
 
-        void _fixBalanceAfterInsert(TNode<value_type> *curr_node)
+        /**
+         * Loops up the tree instead of recursing on the grandfather. Returns
+         * true when the recolouring reached the root, which adds a black
+         * level to every path.
+         */
+        bool _fixBalanceAfterInsert(node_type *curr_node)
         {
-            TNode<value_type> *parent        = curr_node->parent;
-            TNode<value_type> *grandfather   = curr_node->getGrandFather();
-            TNode<value_type> *uncle         = curr_node->getUncle();
-
-            if (curr_node && curr_node != _tree )//! curr_node->getParent() == NULL
+            while (curr_node && curr_node != _tree )//! curr_node->getParent() == NULL
             {
-                if (parent && parent != _tree && parent->color == RED)
+                node_type *parent        = curr_node->parent;
+                node_type *grandfather   = curr_node->getGrandFather();
+                node_type *uncle         = curr_node->getUncle();
+
+                if (!parent || parent == _tree || parent->getColor() != RED)
+                    return false;
+                if (uncle && uncle->getColor() == RED) // only recoloring
                 {
-                    if (uncle && uncle->color == RED) // only recoloring
+                    FT_RBTREE_COUNT(insertRedUncle, 1);
+                    FT_RBTREE_COUNT(recolorings, 2);
+                    parent->flipColor(); // BLACK
+                    uncle->flipColor(); // BLACK
+                    if (grandfather && grandfather != _tree) //it's not the root
                     {
-                        parent->flipColor(); // BLACK
-                        uncle->flipColor(); // BLACK
-                        if (grandfather && grandfather != _tree) //it's not the root
-                            grandfather->flipColor();
-                        _fixBalanceAfterInsert(grandfather);
+                        grandfather->flipColor();
+                        FT_RBTREE_COUNT(recolorings, 1);
                     }
-                    else //uncle black or NULL
+                    curr_node = grandfather;
+                    continue;
+                }
+                //uncle black or NULL
+                FT_RBTREE_COUNT(insertBlackUncle, 1);
+                FT_RBTREE_COUNT(recolorings, 2);
+                //case1 : RR, RL
+                if (parent->isRightChild())
+                {
+                    if (curr_node->isLeftChild())
                     {
-                        //case1 : RR, RL
-                        if (parent && parent->isRightChild())
-                        {
-                            if (curr_node->isLeftChild())
-                            {
-                                _rightRotation(parent);
-                                parent = curr_node;
-                            }
-                            _leftRotation(grandfather);
-                            //recolorRightPart(curr_node, parent, grandfather));
-                        }
-                        //case2 : LL, LR
-                        else if (parent && parent->isLeftChild())
-                        {
-                            if (curr_node->isRightChild())
-                            {
-                                _leftRotation(parent);
-                                parent = curr_node;
-                            }
-                            _rightRotation(grandfather);
-                            //recolorLeftPart(curr_node, parent, grandfather));
-                        }
-                        parent->flipColor();
-                        grandfather->color = RED;
+                        _rightRotation(parent);
+                        parent = curr_node;
+                    }
+                    _leftRotation(grandfather);
+                }
+                //case2 : LL, LR
+                else
+                {
+                    if (curr_node->isRightChild())
+                    {
+                        _leftRotation(parent);
+                        parent = curr_node;
                     }
+                    _rightRotation(grandfather);
                 }
+                parent->flipColor();
+                grandfather->setColor(RED);
+                return false;
             }
+            return true;
         }
 
-        void _fixBalanceAfterDeletion(TNode<value_type> *node)
+        /* Same cases as before; the tail calls became iterations of the loop. */
+        void _fixBalanceAfterDeletion(node_type *node)
         {
-            if (node == _tree)
-                return;
-            TNode<value_type> *sibling = node->getSibling();
-            TNode<value_type> *parent = node->parent;
-            if (!sibling)
-                _fixBalanceAfterDeletion(parent);
-            else
+            while (node != _tree)
             {
-                if (sibling->color == RED)
+                node_type *sibling = node->getSibling();
+                node_type *parent = node->parent;
+                if (!sibling)
+                {
+                    node = parent;
+                    continue;
+                }
+                if (sibling->getColor() == RED)
                 {
-                    parent->color = RED;
-                    sibling->color = BLACK;
+                    FT_RBTREE_COUNT(eraseRedSibling, 1);
+                    FT_RBTREE_COUNT(recolorings, 2);
+                    parent->setColor(RED);
+                    sibling->setColor(BLACK);
                     if (sibling->isRightChild())
                         _leftRotation(parent);
                     else
                         _rightRotation(parent);
-                    _fixBalanceAfterDeletion(node);
+                    continue;
                 }
-                else
+                if ((sibling->left!=NULL && sibling->left->getColor() == RED) ||
+                (sibling->right!= NULL && sibling->right->getColor()==RED))
                 {
-                    if ((sibling->left!=NULL && sibling->left->color == RED) ||
-                    (sibling->right!= NULL && sibling->right->color==RED))
+                    FT_RBTREE_COUNT(eraseRedNephew, 1);
+                    FT_RBTREE_COUNT(recolorings, 2);
+                    if (sibling->left != NULL and sibling->left->getColor() == RED)
                     {
-                        if (sibling->left != NULL and sibling->left->color == RED)
+                        if (sibling->isLeftChild())
                         {
-                            if (sibling->isLeftChild())
-                            {
-                                sibling->left->color = sibling->color;
-                                sibling->color = parent->color;
-                                _rightRotation(parent);
-                            }
-                            else
-                            {
-                                sibling->left->color = parent->color;
-                                _rightRotation(sibling);
-                                _leftRotation(parent);
-                            }
+                            sibling->left->setColor(sibling->getColor());
+                            sibling->setColor(parent->getColor());
+                            FT_RBTREE_COUNT(recolorings, 1);
+                            _rightRotation(parent);
+                        }
+                        else
+                        {
+                            sibling->left->setColor(parent->getColor());
+                            _rightRotation(sibling);
+                            _leftRotation(parent);
                         }
+                    }
                     else
                     {
                         if (sibling->isLeftChild())
                         {
-                            sibling->right->color = parent->color;
+                            sibling->right->setColor(parent->getColor());
                             _leftRotation(sibling);
                             _rightRotation(parent);
                         }
                         else
                         {
-                            sibling->right->color = sibling->color;
-                            sibling->color = parent->color;
+                            sibling->right->setColor(sibling->getColor());
+                            sibling->setColor(parent->getColor());
+                            FT_RBTREE_COUNT(recolorings, 1);
                             _leftRotation(parent);
                         }
                     }
-                    parent->color = BLACK;
-                    } 
-                    else
-                    {
-                        sibling->color = RED;
-                        if (parent->color == BLACK)
-                            _fixBalanceAfterDeletion(parent);
-                        else
-                            parent->color = BLACK;
-                    }
+                    parent->setColor(BLACK);
+                    return;
+                }
+                FT_RBTREE_COUNT(eraseBlackNephews, 1);
+                FT_RBTREE_COUNT(recolorings, 1);
+                sibling->setColor(RED);
+                if (parent->getColor() != BLACK)
+                {
+                    parent->setColor(BLACK);
+                    FT_RBTREE_COUNT(recolorings, 1);
+                    return;
                 }
+                node = parent;
+            }
+        }
+
+        /**
+         * Puts succ, the minimum of node's right subtree, in node's place
+         * and node in succ's, colours included. node is left with at most
+         * one child and can be unlinked; no value is copied or moved.
+         */
+        void _swapWithSuccessor(node_type *node, node_type *succ)
+        {
+            node_type* nodeParent = node->parent;
+            node_type* succRight = succ->right;
+
+            succ->left = node->left;
+            succ->left->parent = succ;
+            if (succ == node->right)
+            {
+                succ->right = node;
+                node->parent = succ;
+            }
+            else
+            {
+                succ->parent->left = node;
+                node->parent = succ->parent;
+                succ->right = node->right;
+                succ->right->parent = succ;
             }
+            node->left = NULL;
+            node->right = succRight;
+            if (succRight != NULL)
+                succRight->parent = node;
+
+            succ->parent = nodeParent;
+            if (nodeParent == NULL)
+                _tree = succ;
+            else if (nodeParent->left == node)
+                nodeParent->left = succ;
+            else
+                nodeParent->right = succ;
+
+            bool color = node->getColor();
+            node->setColor(succ->getColor());
+            succ->setColor(color);
+
+            /* positions keep their subtree data; the erase path refreshes it */
+            typename Augment::node_data data = *node;
+            static_cast<typename Augment::node_data&>(*node) = *succ;
+            static_cast<typename Augment::node_data&>(*succ) = data;
+        }
+
+        /**
+         * Takes node out of the tree without freeing it. The erase helpers
+         * below only relink; RBTdelete and extract decide what happens to
+         * the node afterwards.
+         */
+        void _unlinkNode(node_type *node)
+        {
+            --_size;
+            _updateMinMaxBeforeDelete(node);
+            if (node == _tree)
+                _deleteRoot();
+            else
+                _BSTdelete(node);
         }
 
         void _deleteRoot()
         {
             if (_tree->left == NULL && _tree->right == NULL)
-            {
-                deleteNode(_tree);
                 _tree = NULL;
-            }
             else if (_tree->left == NULL || _tree->right == NULL)
             {
-                TNode<value_type>* tmp = _tree;
+                node_type* tmp = _tree;
 
-                if (_tree->left)
-                {
-                    _tree = _tree->left;
-                    _tree->color = BLACK;
-                    deleteNode(tmp);
-                  
-                    tmp = NULL;
-                }
+                if (tmp->left)
+                    _tree = tmp->left;
                 else
-                {
-                    _tree = _tree->right;
-                    _tree->color = BLACK;
-                    deleteNode(tmp);
-                  
-                    tmp = NULL;
-                }
+                    _tree = tmp->right;
+                _tree->parent = NULL;
+                _tree->setColor(BLACK);
             }
             else if (_tree->left != NULL && _tree->right != NULL) //it will always be black
             {
-                TNode<value_type>* inorder_successor = getMin(_tree->right);
-                
-                _myPairAlloc.destroy(_tree->data);
-                _myPairAlloc.construct(_tree->data, *(inorder_successor->data));
-                _BSTdelete(inorder_successor);
-                
+                node_type* root = _tree;
+
+                _swapWithSuccessor(root, getMin(root->right));
+                _BSTdelete(root);
             }
         }
 
-        void _BSTdelete(TNode<value_type> *tmp)
+        void _BSTdelete(node_type *tmp)
         {
            
             /*  Node to be deleted is the leaf */
             if (tmp->right == NULL && tmp->left == NULL)
             {
                         //consider case when tmp->color == black => double black
-                TNode<value_type>* parent = tmp->parent;
-                if (tmp->color == BLACK)
+                node_type* parent = tmp->parent;
+                if (tmp->getColor() == BLACK)
                     _fixBalanceAfterDeletion(tmp);
                            // std::cout<<"fixDoubleBlack(tmp)"<<std::endl;
                 else
                 {
                     if (tmp->getSibling())
-                        tmp->getSibling()->color = RED;
+                        tmp->getSibling()->setColor(RED);
                 }
                 if (tmp->isRightChild())
                     parent->right = NULL;
                 else
                     parent->left = NULL;
-                deleteNode(tmp);
-                  
-               // tmp = NULL;
-               
+                _updatePath(parent);
                 return;
             }
                     //fix balance called here
@@ -605,9 +2990,9 @@ namespace ft{
 
             else if (tmp->left== NULL || tmp->right == NULL)
             {
-                TNode<value_type>* parent = tmp->parent;
-                TNode<value_type>* toReplaceBy;
-                bool colorDeleted = tmp->color;
+                node_type* parent = tmp->parent;
+                node_type* toReplaceBy;
+                bool colorDeleted = tmp->getColor();
                         
                 if (tmp->isRightChild()) // We check if right or left to update the parent
                 {
@@ -637,13 +3022,11 @@ namespace ft{
                     }
                     toReplaceBy = parent->left;
                 }
-                    deleteNode(tmp);
-                  
-                    tmp = NULL;
-                if ((toReplaceBy == NULL || toReplaceBy->color == BLACK) && colorDeleted == BLACK)
+                    _updatePath(parent);
+                if ((toReplaceBy == NULL || toReplaceBy->getColor() == BLACK) && colorDeleted == BLACK)
                     _fixBalanceAfterDeletion(toReplaceBy);
                     else
-                        toReplaceBy->color = BLACK;
+                        toReplaceBy->setColor(BLACK);
                     return;
                 }
 
@@ -655,13 +3038,13 @@ namespace ft{
 
                 else if (tmp->left!= NULL && tmp->right != NULL)
                 {
-                    TNode<value_type>* inorder_successor = getMin(tmp->right);
-                    _myPairAlloc.destroy(tmp->data);
-                    _myPairAlloc.construct(tmp->data, *(inorder_successor->data));
-                    _BSTdelete(inorder_successor);
+                    _swapWithSuccessor(tmp, getMin(tmp->right));
+                    _BSTdelete(tmp);
                 }
         }
 
         
     };
-}
\ No newline at end of file
+}
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * Readers of a concurrent_RBtree racing a writer that keeps inserting and
+ * erasing. Keys that are never erased must always be found with their
+ * values, and the tree must end up with exactly those keys. Built with
+ * -fsanitize=thread where the compiler has it.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../concurrent_red_black_tree.hpp"
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); return 1; } } while (0)
+
+typedef std::pair<const long, long>                                     pair_type;
+typedef ft::concurrent_RBtree<pair_type>                                tree_type;
+
+static const long keys = 500;
+
+int main()
+{
+    tree_type tree;
+    for (long k = 1; k < 2 * keys; k += 2)
+        CHECK(tree.insert(pair_type(k, -k)));
+
+    std::atomic<bool> done(false);
+    std::atomic<long> misses(0);
+    std::thread       writer([&] {
+        for (int round = 0; round < 10; ++round)
+        {
+            for (long k = 0; k < 2 * keys; k += 2)
+                tree.insert(pair_type(k, -k));
+            for (long k = 0; k < 2 * keys; k += 2)
+                tree.erase(k);
+        }
+        done.store(true);
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r)
+        readers.push_back(std::thread([&, r] {
+            long k = 2 * r + 1;
+            while (!done.load())
+            {
+                long value = 0;
+                if (!tree.visit(k, [&value](const pair_type& p) { value = p.second; }) || value != -k)
+                    ++misses;
+                tree_type::read_guard guard(tree);
+                const pair_type*      even = guard.search(k - 1);
+                if (even != NULL && even->second != 1 - k)
+                    ++misses;
+                if (!tree.contains(k))
+                    ++misses;
+                k = (k + 2 * 37) % (2 * keys);
+            }
+        }));
+    writer.join();
+    for (size_t r = 0; r < readers.size(); ++r)
+        readers[r].join();
+
+    CHECK(misses.load() == 0);
+    tree.reclaim();
+    CHECK(tree.size() == size_t(keys));
+    for (long k = 0; k < 2 * keys; ++k)
+        CHECK(tree.contains(k) == (k % 2 == 1));
+    return 0;
+}
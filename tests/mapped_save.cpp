@@ -0,0 +1,67 @@
+/**
+ * Saving a mapped tree back to the file it is mapped from, both while it
+ * still reads the image and after a write has converted it. Each save
+ * must leave a complete image at the path and no temporary file.
+ */
+
+#include <cstdio>
+#include <unistd.h>
+#include <utility>
+
+#include "../mapped_red_black_tree.hpp"
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); return 1; } } while (0)
+
+typedef std::pair<const long, long>                                     pair_type;
+typedef ft::RBtree<pair_type, std::less<long>, std::allocator<pair_type> > tree_type;
+typedef ft::rb_image<pair_type, std::less<long> >                       image_type;
+typedef ft::mapped_RBtree<pair_type, std::less<long> >                  mapped_type;
+
+static const char *path = "test_mapped_save.img";
+
+static bool holds(const char *file, long n, long step)
+{
+    image_type image(file);
+    if (image.size() != size_t(n) || !image.checkInvariants())
+        return false;
+    for (long i = 0; i < n; ++i)
+    {
+        const pair_type *value = image.search(step * i);
+        if (value == NULL || value->second != i)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    const long n = 10000;
+    {
+        tree_type tree;
+        for (long i = 0; i < n; ++i)
+            tree.RBTinsert(pair_type(2 * i, i));
+        image_type::save(tree, path);
+    }
+    CHECK(holds(path, n, 2));
+
+    {
+        mapped_type map(path);
+        CHECK(map.isMapped());
+        map.save(path);
+        CHECK(map.search(2 * (n - 1)) != NULL);
+    }
+    CHECK(holds(path, n, 2));
+
+    {
+        mapped_type map(path);
+        map.RBTinsert(pair_type(2 * n, n));
+        CHECK(!map.isMapped());
+        map.save(path);
+    }
+    CHECK(holds(path, n + 1, 2));
+
+    std::string temporary = std::string(path) + ".tmp";
+    CHECK(::access(temporary.c_str(), F_OK) != 0);
+    std::remove(path);
+    return 0;
+}
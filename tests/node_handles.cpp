@@ -0,0 +1,61 @@
+/**
+ * Node handles from extract and split on a tree that owns its
+ * node_pool_allocator alone. clear() must not drop the pool's arena while
+ * a handle is out; built with -fsanitize=address where the compiler has
+ * it, so a handle left pointing into freed slabs fails the test.
+ */
+
+#include <cstdio>
+#include <utility>
+
+#include "../red_black_tree.hpp"
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); return 1; } } while (0)
+
+typedef std::pair<const long, long>                                             pair_type;
+typedef ft::RBtree<pair_type, std::less<long>, ft::node_pool_allocator<pair_type> > tree_type;
+
+static void fill(tree_type& tree, long n)
+{
+    for (long i = 0; i < n; ++i)
+        tree.RBTinsert(pair_type(i, 10 * i));
+}
+
+int main()
+{
+    tree_type tree;
+
+    fill(tree, 1000);
+    tree_type::node_type* handle = tree.extract(5);
+    CHECK(handle != NULL && tree.size() == 999);
+    tree.clear();
+    CHECK(handle->value.first == 5 && handle->value.second == 50);
+    CHECK(tree.insertNode(handle).second);
+    CHECK(tree.size() == 1 && tree.checkInvariants());
+
+    /* right shares the pool until it is destroyed, then tree owns it alone */
+    tree.clear();
+    fill(tree, 1000);
+    tree_type::node_type* pivot;
+    {
+        tree_type right;
+        pivot = tree.split(500, right);
+        CHECK(pivot != NULL && tree.size() == 500 && right.size() == 499);
+    }
+    tree.clear();
+    CHECK(pivot->value.first == 500 && pivot->value.second == 5000);
+    tree_type empty;
+    tree.join(pivot, empty);
+    CHECK(tree.size() == 1 && tree.checkInvariants());
+
+    /* once every handle is back, clear() may drop the arena again */
+    fill(tree, 1000);
+    handle = tree.extract(7);
+    tree.deleteNode(handle);
+    handle = tree.extract(8);
+    CHECK(tree.insertNode(handle).second);
+    tree.clear();
+    fill(tree, 100);
+    CHECK(tree.size() == 100 && tree.checkInvariants());
+    return 0;
+}
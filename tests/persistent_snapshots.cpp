@@ -0,0 +1,73 @@
+/**
+ * Snapshots of a persistent_RBtree keep the contents they were taken
+ * with while the tree and other snapshots change, checked against a
+ * std::map copied at the same moment. Built with -fsanitize=address
+ * where the compiler has it, so a reference count that frees a shared
+ * node early, or never, fails the test.
+ */
+
+#include <cstdio>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "../persistent_red_black_tree.hpp"
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); return 1; } } while (0)
+
+typedef std::pair<const long, long>                                     pair_type;
+typedef ft::persistent_RBtree<pair_type>                                tree_type;
+typedef std::map<long, long>                                            map_type;
+
+static bool same(const tree_type& tree, const map_type& expected)
+{
+    std::vector<std::pair<long, long> > seen;
+    tree.rangeScan(-1, 1 << 20, [&seen](const pair_type& p) { seen.push_back(std::make_pair(p.first, p.second)); });
+    return tree.size() == expected.size() && seen == std::vector<std::pair<long, long> >(expected.begin(), expected.end());
+}
+
+int main()
+{
+    tree_type              tree;
+    map_type               expected;
+    std::vector<tree_type> snapshots;
+    std::vector<map_type>  versions;
+    unsigned long          seed = 7;
+
+    for (int step = 0; step < 4000; ++step)
+    {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        long k = static_cast<long>((seed >> 33) % 1500);
+        if ((seed >> 20) % 3 == 0)
+            CHECK(tree.erase(k) == (expected.erase(k) != 0));
+        else
+            CHECK(tree.insert(pair_type(k, step)) == expected.insert(std::make_pair(k, long(step))).second);
+        if (step % 250 == 0)
+        {
+            snapshots.push_back(tree.snapshot());
+            versions.push_back(expected);
+        }
+        if (step % 1000 == 999)
+        {
+            /* a snapshot is a tree of its own and may be changed too */
+            tree_type& old = snapshots[snapshots.size() / 2];
+            map_type&  oldVersion = versions[versions.size() / 2];
+            old.insert(pair_type(5000 + step, step));
+            oldVersion.insert(std::make_pair(5000L + step, long(step)));
+        }
+    }
+    CHECK(same(tree, expected));
+    for (size_t i = 0; i < snapshots.size(); ++i)
+        CHECK(same(snapshots[i], versions[i]));
+
+    /* dropping every other snapshot must leave the rest intact */
+    for (size_t i = 0; i < snapshots.size(); i += 2)
+        snapshots[i].clear();
+    for (size_t i = 1; i < snapshots.size(); i += 2)
+        CHECK(same(snapshots[i], versions[i]));
+    tree.clear();
+    CHECK(tree.isEmpty() && tree.search(1) == NULL);
+    for (size_t i = 1; i < snapshots.size(); i += 2)
+        CHECK(same(snapshots[i], versions[i]));
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * split, join, unite, intersect, subtract, extract/insertNode and merge
+ * checked against std::map on random keys, with and without subtree
+ * sizes in the nodes. The node pool run gives each operand of the set
+ * operations its own pool, so they take the copying path.
+ */
+
+#include <cstdio>
+#include <map>
+#include <utility>
+
+#include "../red_black_tree.hpp"
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); return 1; } } while (0)
+
+typedef std::pair<const long, long>                                             pair_type;
+typedef std::map<long, long>                                                    map_type;
+
+static unsigned long seed = 12345;
+
+static long nextKey(long range)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return static_cast<long>(seed % static_cast<unsigned long>(range));
+}
+
+template<class Tree>
+static void fill(Tree& tree, map_type& expected, size_t n, long range, long tag)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        long k = nextKey(range);
+        if (tree.insert(pair_type(k, tag)).second)
+            expected.insert(std::make_pair(k, tag));
+    }
+}
+
+template<class Tree>
+static bool same(const Tree& tree, const map_type& expected)
+{
+    if (tree.size() != expected.size() || !tree.checkInvariants())
+        return false;
+    typename Tree::const_iterator it = tree.begin();
+    for (map_type::const_iterator e = expected.begin(); e != expected.end(); ++e, ++it)
+        if (it == tree.end() || it->first != e->first || it->second != e->second)
+            return false;
+    return it == tree.end();
+}
+
+template<class Tree>
+static int setOperations(size_t n, size_t m, long range)
+{
+    for (int op = 0; op < 3; ++op)
+    {
+        Tree     a;
+        Tree     b;
+        map_type inA;
+        map_type inB;
+        fill(a, inA, n, range, 1);
+        fill(b, inB, m, range, 2);
+
+        map_type expected;
+        for (map_type::const_iterator it = inA.begin(); it != inA.end(); ++it)
+            if ((op == 0) || ((op == 1) == (inB.count(it->first) != 0)))
+                expected.insert(*it);
+        if (op == 0)
+        {
+            expected.insert(inB.begin(), inB.end());
+            a.unite(b);
+        }
+        else if (op == 1)
+            a.intersect(b);
+        else
+            a.subtract(b);
+        CHECK(same(a, expected));
+        CHECK(b.isEmpty() && b.checkInvariants());
+    }
+    return 0;
+}
+
+template<class Tree>
+static int splitAndJoin(size_t n, long range)
+{
+    Tree     tree;
+    map_type expected;
+    fill(tree, expected, n, range, 1);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        long                       k = nextKey(range + 2) - 1;
+        Tree                       right;
+        typename Tree::node_type*  pivot = tree.split(k, right);
+        map_type                   less(expected.begin(), expected.lower_bound(k));
+        map_type                   greater(expected.upper_bound(k), expected.end());
+
+        CHECK((pivot != NULL) == (expected.count(k) != 0));
+        CHECK(same(tree, less));
+        CHECK(same(right, greater));
+        if (pivot != NULL)
+        {
+            CHECK(pivot->value.first == k);
+            tree.join(pivot, right);
+        }
+        else
+            tree.unite(right);
+        CHECK(right.isEmpty());
+        CHECK(same(tree, expected));
+    }
+    return 0;
+}
+
+template<class Tree>
+static int handlesAndMerge(size_t n, long range)
+{
+    Tree     a;
+    Tree     b(a);      /* shares a's allocator, so nodes may move between them */
+    map_type inA;
+    map_type inB;
+    fill(a, inA, n, range, 1);
+    fill(b, inB, n, range, 2);
+
+    for (int i = 0; i < 50; ++i)
+    {
+        long                      k = nextKey(range);
+        typename Tree::node_type* node = a.extract(k);
+        CHECK((node != NULL) == (inA.erase(k) != 0));
+        if (node == NULL)
+            continue;
+        std::pair<typename Tree::node_type*, bool> placed = b.insertNode(node);
+        CHECK(placed.second == (inB.count(k) == 0));
+        if (placed.second)
+            inB.insert(std::make_pair(k, 1L));
+        else
+            b.deleteNode(node);
+    }
+    CHECK(same(a, inA));
+    CHECK(same(b, inB));
+
+    map_type kept;
+    for (map_type::const_iterator it = inB.begin(); it != inB.end(); ++it)
+        if (!inA.insert(*it).second)
+            kept.insert(*it);
+    a.merge(b);
+    CHECK(same(a, inA));
+    CHECK(same(b, kept));
+    return 0;
+}
+
+template<class Tree>
+static int run()
+{
+    if (setOperations<Tree>(2000, 2000, 3000) || setOperations<Tree>(5000, 30, 10000) || setOperations<Tree>(0, 100, 1000))
+        return 1;
+    if (splitAndJoin<Tree>(3000, 5000) || splitAndJoin<Tree>(1, 3))
+        return 1;
+    return handlesAndMerge<Tree>(2000, 3000);
+}
+
+int main()
+{
+    typedef std::allocator<pair_type>           plain;
+    typedef ft::node_pool_allocator<pair_type>  pooled;
+
+    if (run<ft::RBtree<pair_type, std::less<long>, plain> >())
+        return 1;
+    if (run<ft::RBtree<pair_type, std::less<long>, plain, ft::rb_order_statistic> >())
+        return 1;
+    if (run<ft::RBtree<pair_type, std::less<long>, pooled, ft::rb_order_statistic, ft::rb_compact_node> >())
+        return 1;
+    return 0;
+}
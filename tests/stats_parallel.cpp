@@ -0,0 +1,61 @@
+/**
+ * Stats mode under threads: buildFromSortedParallel, uniteParallel and
+ * concurrent const lookups all count into one rb_stats block. Built
+ * with -fsanitize=thread where the compiler has it, so an unsynchronized
+ * count fails the test.
+ */
+
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../red_black_tree.hpp"
+
+#define CHECK(cond) do { if (!(cond)) { std::printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); return 1; } } while (0)
+
+typedef std::pair<const long, long>                                     pair_type;
+typedef ft::RBtree<pair_type, std::less<long>, std::allocator<pair_type> > tree_type;
+
+int main()
+{
+    std::vector<std::pair<long, long> > evens;
+    std::vector<std::pair<long, long> > thirds;
+    for (long i = 0; i < 100000; ++i)
+    {
+        evens.push_back(std::make_pair(2 * i, i));
+        thirds.push_back(std::make_pair(3 * i, i));
+    }
+
+    tree_type a;
+    tree_type b;
+    a.buildFromSortedParallel(evens.begin(), evens.end(), 4);
+    b.buildFromSortedParallel(thirds.begin(), thirds.end(), 4);
+    CHECK(a.stats().allocations == evens.size());
+    CHECK(b.stats().allocations == thirds.size());
+
+    /* The forked halves count into scratch trees; their counts must reach a. */
+    tree_type c;
+    tree_type d;
+    c.buildFromSorted(evens.begin(), evens.end());
+    d.buildFromSorted(thirds.begin(), thirds.end());
+    c.resetStats();
+    c.unite(d);
+    a.resetStats();
+    a.uniteParallel(b, 4);
+    CHECK(a.checkInvariants());
+    CHECK(a.size() == c.size());
+    CHECK(a.stats().deallocations == size_t(200000 / 6 + 1));
+    CHECK(a.stats().deallocations == c.stats().deallocations);
+    CHECK(a.stats().rotations == c.stats().rotations);
+    CHECK(a.stats().recolorings == c.stats().recolorings);
+    CHECK(a.stats().rotations > 0);
+
+    a.resetStats();
+    std::thread first([&a] { for (long k = 0; k < 10000; ++k) a.search(k); });
+    std::thread second([&a] { for (long k = 0; k < 10000; ++k) a.search(k); });
+    first.join();
+    second.join();
+    CHECK(a.stats().lookups == 20000);
+    return 0;
+}